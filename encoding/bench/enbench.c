@@ -0,0 +1,728 @@
+/*
+	File: enbench.c
+	Creation: 18-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Throughput benchmark for the encoding module. Generates synthetic corpora
+		and times every decoder and encoder of encoding.h on them, for every
+		instruction set the CPU supports and several buffer sizes.
+
+		Build from the repository root:
+
+			cc -O2 -pthread -DARCH_LITTLE_ENDIAN -Iencoding/include \
+				encoding/bench/enbench.c encoding/src/[a-z]*.c -o enbench
+
+		Usage:
+
+			enbench [-t seconds] [-s bytes] [-i isa] [-c corpus] [-f function]
+
+			-t: minimum time per measure (0.2 by default).
+			-s: input size, may be repeated (1K, 64K, 1M and 16M by default).
+			-i, -c, -f: only run the instruction set, corpus or function named.
+
+		Results go to stdout as CSV, one line per measure:
+
+			isa,function,corpus,size,bytes,iterations,seconds,gbps
+
+		"bytes" is the input size of the function, which depends on its input
+		encoding, and "gbps" is input bytes per second divided by 10^9.
+		Functions stop at malformed input, so on the "invalid" corpus every call
+		skips the bad unit and restarts, as a caller would.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "encoding.h"
+
+#define BN_MAX_SIZES 16
+// Share of the invalid corpus units that are corrupted, per thousand.
+#define BN_INVALID_RATE 10
+
+enum BNCORPUS {CO_ASCII, CO_LATIN1, CO_CYRILLIC, CO_CJK, CO_EMOJI, CO_RANDOM, CO_INVALID, CO_COUNT};
+
+static const char* CORPUSNAMES[CO_COUNT] = {"ascii", "latin1", "cyrillic", "cjk", "emoji", "random", "invalid"};
+static const char* ISANAMES[] = {"scalar", "sse2", "avx2", "avx512"};
+
+/*
+	A corpus in every input encoding. "ucs4" holds native UCS-4 characters and
+	"latin1" the same with '?' for those Latin-1 lacks. "base64" (padded,
+	standard alphabet) and "hex" are the text of the UTF-8 bytes, taken as
+	binary data.
+*/
+struct BNDATA {
+	BYTE* utf8;
+	unsigned int nutf8;
+	BYTE* utf16le;
+	BYTE* utf16be;
+	unsigned int nutf16;
+	BYTE* ucs4be;
+	UCS4* ucs4;
+	unsigned int nucs4;
+	BYTE* latin1;
+	BYTE* base64;
+	unsigned int nbase64;
+	BYTE* hex;
+	// Output buffer, large enough for any function.
+	BYTE* out;
+	unsigned int nout;
+};
+
+// Input of a benchmarked function.
+enum BNINPUT {IN_UTF8, IN_UTF16LE, IN_UTF16BE, IN_UCS4, IN_UCS4BE, IN_LATIN1, IN_BASE64, IN_HEX};
+
+// "validonly": skipped on the invalid corpus, because every restart costs a
+// pass over the rest of the input.
+struct BNFUNC {
+	const char* name;
+	enum BNINPUT input;
+	void (*run) (struct BNDATA* b);
+	BOOL validonly;
+};
+
+static unsigned long long Seed = 0x9E3779B97F4A7C15ULL;
+// Results nobody reads, so that the calls are not optimized away.
+static volatile unsigned int Sink;
+
+/*
+	xorshift64* generator, the same sequence on every host.
+*/
+static unsigned int BN_Random (unsigned int n) {
+	Seed ^= Seed >> 12;
+	Seed ^= Seed << 25;
+	Seed ^= Seed >> 27;
+
+	return (unsigned int) ((Seed * 0x2545F4914F6CDD1DULL) >> 32) % n;
+}
+
+/*
+	Next character of a corpus. Text corpora mix in spaces and punctuation in
+	the proportions of running text.
+*/
+static UCS4 BN_NextChar (enum BNCORPUS corpus) {
+	static const char PUNCT[] = "  ,.";
+	UCS4 c;
+
+	switch (corpus) {
+		case CO_ASCII:
+			if (BN_Random (6) == 0)
+				return ' ';
+			return BN_Random (20) == 0 ? (UCS4) PUNCT[BN_Random (4)] : 'a' + BN_Random (26);
+		case CO_LATIN1:
+			if (BN_Random (6) == 0)
+				return ' ';
+			return BN_Random (4) == 0 ? 0xC0 + BN_Random (64) : 'a' + BN_Random (26);
+		case CO_CYRILLIC:
+			if (BN_Random (7) == 0)
+				return BN_Random (10) == 0 ? (UCS4) PUNCT[BN_Random (4)] : ' ';
+			return 0x0430 + BN_Random (32);
+		case CO_CJK:
+			if (BN_Random (20) == 0)
+				return BN_Random (2) ? 0x3002 : 0x3001;
+			return 0x4E00 + BN_Random (0x5200);
+		case CO_EMOJI:
+			if (BN_Random (2) == 0)
+				return BN_Random (3) == 0 ? ' ' : 'a' + BN_Random (26);
+			return 0x1F300 + BN_Random (0x350);
+		default:
+			// Any scalar value, surrogates excluded.
+			do
+				c = BN_Random (0x110000);
+			while ((c >= 0xD800) && (c <= 0xDFFF));
+			return c;
+	}
+}
+
+static void BN_PutUTF16 (BYTE* d, unsigned int w, BOOL be) {
+	d[be ? 0 : 1] = (BYTE) (w >> 8);
+	d[be ? 1 : 0] = (BYTE) w;
+}
+
+/*
+	Base64 and hex text of the UTF-8 corpus.
+*/
+static void BN_Binary (struct BNDATA* b) {
+	struct ENCBASE64 e;
+	struct ENCSTREAM in, out;
+
+	b -> nbase64 = EN_Base64EncodedLength (b -> nutf8, TRUE);
+	b -> base64 = (BYTE*) malloc (b -> nbase64);
+	EN_InitBase64 (&e, B64_STANDARD, TRUE);
+	EN_InitStream (&in, b -> utf8, b -> nutf8);
+	EN_InitStream (&out, b -> base64, b -> nbase64);
+	EN_Base64Encode (&e, &in, &out);
+	EN_Base64EncodeFinish (&e, &out);
+	b -> hex = (BYTE*) malloc (2 * b -> nutf8);
+	EN_InitStream (&in, b -> utf8, b -> nutf8);
+	EN_InitStream (&out, b -> hex, 2 * b -> nutf8);
+	EN_HexEncode (&in, &out, FALSE);
+}
+
+/*
+	Generates "corpus" with at least "size" UTF-8 bytes and its other encodings.
+	The invalid corpus is random text with BN_INVALID_RATE per thousand units
+	replaced by stray continuation bytes, lone surrogates or values out of range.
+*/
+static void BN_Generate (struct BNDATA* b, enum BNCORPUS corpus, unsigned int size) {
+	struct ENCSTREAM s;
+	unsigned int i, n, u;
+	UCS4 c;
+
+	n = size + 1;
+	b -> ucs4 = (UCS4*) malloc (n * sizeof (UCS4));
+	b -> utf8 = (BYTE*) malloc (size + 8);
+	b -> utf16le = (BYTE*) malloc (4 * n);
+	b -> utf16be = (BYTE*) malloc (4 * n);
+	b -> ucs4be = (BYTE*) malloc (n * sizeof (UCS4));
+	b -> latin1 = (BYTE*) malloc (n);
+	EN_InitStream (&s, b -> utf8, size + 8);
+	u = 0;
+	for (i = 0; s.index < size; i++) {
+		c = BN_NextChar (corpus);
+		b -> ucs4[i] = c;
+		EN_UCS4ToUTF8 (c, &s);
+		if (c < 0x10000) {
+			BN_PutUTF16 (b -> utf16le + u, c, FALSE);
+			BN_PutUTF16 (b -> utf16be + u, c, TRUE);
+			u += 2;
+		} else {
+			BN_PutUTF16 (b -> utf16le + u, 0xD800 | (c - 0x10000) >> 10, FALSE);
+			BN_PutUTF16 (b -> utf16be + u, 0xD800 | (c - 0x10000) >> 10, TRUE);
+			BN_PutUTF16 (b -> utf16le + u + 2, 0xDC00 | (c & 0x3FF), FALSE);
+			BN_PutUTF16 (b -> utf16be + u + 2, 0xDC00 | (c & 0x3FF), TRUE);
+			u += 4;
+		}
+	}
+	b -> nutf8 = s.index;
+	b -> nutf16 = u;
+	b -> nucs4 = i;
+	if (corpus == CO_INVALID) {
+		for (i = 0; i < b -> nutf8; i++)
+			if (BN_Random (1000) < BN_INVALID_RATE)
+				b -> utf8[i] = (BYTE) (0x80 + BN_Random (0x40));
+		for (i = 0; i < b -> nutf16; i += 2)
+			if (BN_Random (1000) < BN_INVALID_RATE) {
+				BN_PutUTF16 (b -> utf16le + i, 0xDC00 + BN_Random (0x400), FALSE);
+				BN_PutUTF16 (b -> utf16be + i, 0xDC00 + BN_Random (0x400), TRUE);
+			}
+		for (i = 0; i < b -> nucs4; i++)
+			if (BN_Random (1000) < BN_INVALID_RATE)
+				b -> ucs4[i] = 0x80000000 + BN_Random (0x1000);
+	}
+	for (i = 0; i < b -> nucs4; i++) {
+		b -> ucs4be[4 * i] = (BYTE) (b -> ucs4[i] >> 24);
+		b -> ucs4be[4 * i + 1] = (BYTE) (b -> ucs4[i] >> 16);
+		b -> ucs4be[4 * i + 2] = (BYTE) (b -> ucs4[i] >> 8);
+		b -> ucs4be[4 * i + 3] = (BYTE) b -> ucs4[i];
+		b -> latin1[i] = b -> ucs4[i] <= 0xFF ? (BYTE) b -> ucs4[i] : '?';
+	}
+	b -> nout = 4 * n + 16;
+	b -> out = (BYTE*) malloc (b -> nout);
+	BN_Binary (b);
+}
+
+static void BN_Free (struct BNDATA* b) {
+	free (b -> ucs4);
+	free (b -> utf8);
+	free (b -> utf16le);
+	free (b -> utf16be);
+	free (b -> latin1);
+	free (b -> base64);
+	free (b -> hex);
+	free (b -> ucs4be);
+	free (b -> out);
+}
+
+/*
+	Per character decoding. A failure that is not the end of the buffer skips
+	one unit of "unit" bytes.
+*/
+static void BN_Decode (BYTE* buffer, unsigned int size, unsigned int unit, BOOL (*decode) (struct ENCSTREAM*, UCS4*)) {
+	struct ENCSTREAM s;
+	unsigned int sum;
+	UCS4 c;
+
+	EN_InitStream (&s, buffer, size);
+	sum = 0;
+	while (s.index < s.size) {
+		if (decode (&s, &c))
+			sum += c;
+		else if (s.eob)
+			break;
+		else
+			s.index += unit;
+	}
+	Sink = sum;
+}
+
+static void BN_UTF8ToUCS4 (struct BNDATA* b) {
+	BN_Decode (b -> utf8, b -> nutf8, 1, EN_UTF8ToUCS4);
+}
+
+static void BN_UTF16LeToUCS4 (struct BNDATA* b) {
+	BN_Decode (b -> utf16le, b -> nutf16, 2, EN_UTF16LeToUCS4);
+}
+
+static void BN_UTF16BeToUCS4 (struct BNDATA* b) {
+	BN_Decode (b -> utf16be, b -> nutf16, 2, EN_UTF16BeToUCS4);
+}
+
+static void BN_ReadUCS4Be (struct BNDATA* b) {
+	BN_Decode (b -> ucs4be, b -> nucs4 * sizeof (UCS4), sizeof (UCS4), EN_ReadUCS4Be);
+}
+
+/*
+	Per character encoding of the UCS-4 corpus. Characters that can't be
+	encoded are skipped.
+*/
+static void BN_Encode (struct BNDATA* b, BOOL (*encode) (UCS4, struct ENCSTREAM*)) {
+	struct ENCSTREAM s;
+	unsigned int i;
+
+	EN_InitStream (&s, b -> out, b -> nout);
+	for (i = 0; i < b -> nucs4; i++)
+		encode (b -> ucs4[i], &s);
+	Sink = s.index;
+}
+
+static void BN_UCS4ToUTF8 (struct BNDATA* b) {
+	BN_Encode (b, EN_UCS4ToUTF8);
+}
+
+static void BN_UCS4ToUTF16 (struct BNDATA* b) {
+	BN_Encode (b, EN_UCS4ToUTF16);
+}
+
+/*
+	Bulk transcoding. Malformed input is skipped one unit at a time.
+*/
+static void BN_Transcode (BYTE* buffer, unsigned int size, unsigned int unit, struct BNDATA* b,
+			BOOL (*transcode) (struct ENCSTREAM*, struct ENCSTREAM*)) {
+	struct ENCSTREAM in, out;
+
+	EN_InitStream (&in, buffer, size);
+	EN_InitStream (&out, b -> out, b -> nout);
+	while (!transcode (&in, &out) && !in.eob && !out.eob)
+		in.index += unit;
+	Sink = out.index;
+}
+
+static void BN_UTF8ToUTF16Le (struct BNDATA* b) {
+	BN_Transcode (b -> utf8, b -> nutf8, 1, b, EN_UTF8ToUTF16Le);
+}
+
+static void BN_UTF8ToUTF16Be (struct BNDATA* b) {
+	BN_Transcode (b -> utf8, b -> nutf8, 1, b, EN_UTF8ToUTF16Be);
+}
+
+static void BN_UTF16LeToUTF8 (struct BNDATA* b) {
+	BN_Transcode (b -> utf16le, b -> nutf16, 2, b, EN_UTF16LeToUTF8);
+}
+
+static void BN_UTF16BeToUTF8 (struct BNDATA* b) {
+	BN_Transcode (b -> utf16be, b -> nutf16, 2, b, EN_UTF16BeToUTF8);
+}
+
+/*
+	Lossy transcoding never stops at malformed input.
+*/
+static void BN_UTF8ToUTF16LeLossy (struct BNDATA* b) {
+	BN_Transcode (b -> utf8, b -> nutf8, 1, b, EN_UTF8ToUTF16LeLossy);
+}
+
+static void BN_UTF16LeToUTF8Lossy (struct BNDATA* b) {
+	BN_Transcode (b -> utf16le, b -> nutf16, 2, b, EN_UTF16LeToUTF8Lossy);
+}
+
+/*
+	Single byte charset transcoding, with Latin-1.
+*/
+static void BN_TranscodeSB (BYTE* buffer, unsigned int size, unsigned int unit, struct BNDATA* b,
+			BOOL (*transcode) (enum ENCODING, struct ENCSTREAM*, struct ENCSTREAM*)) {
+	struct ENCSTREAM in, out;
+
+	EN_InitStream (&in, buffer, size);
+	EN_InitStream (&out, b -> out, b -> nout);
+	while (!transcode (ENC_LATIN1, &in, &out) && !in.eob && !out.eob)
+		in.index += unit;
+	Sink = out.index;
+}
+
+static void BN_Latin1ToUTF8 (struct BNDATA* b) {
+	BN_TranscodeSB (b -> latin1, b -> nucs4, 1, b, EN_SingleByteToUTF8);
+}
+
+static void BN_Latin1ToUTF16Le (struct BNDATA* b) {
+	BN_TranscodeSB (b -> latin1, b -> nucs4, 1, b, EN_SingleByteToUTF16Le);
+}
+
+static void BN_UTF8ToLatin1 (struct BNDATA* b) {
+	BN_TranscodeSB (b -> utf8, b -> nutf8, 1, b, EN_UTF8ToSingleByte);
+}
+
+static void BN_UTF16LeToLatin1 (struct BNDATA* b) {
+	BN_TranscodeSB (b -> utf16le, b -> nutf16, 2, b, EN_UTF16LeToSingleByte);
+}
+
+/*
+	Multi-threaded transcoding, one thread per processor.
+*/
+static void BN_TranscodeParallel (BYTE* buffer, unsigned int size, unsigned int unit, struct BNDATA* b,
+			BOOL (*transcode) (struct ENCSTREAM*, struct ENCSTREAM*, unsigned int)) {
+	struct ENCSTREAM in, out;
+
+	EN_InitStream (&in, buffer, size);
+	EN_InitStream (&out, b -> out, b -> nout);
+	while (!transcode (&in, &out, 0) && !in.eob && !out.eob)
+		in.index += unit;
+	Sink = out.index;
+}
+
+static void BN_UTF8ToUTF16LeParallel (struct BNDATA* b) {
+	BN_TranscodeParallel (b -> utf8, b -> nutf8, 1, b, EN_UTF8ToUTF16LeParallel);
+}
+
+static void BN_UTF16LeToUTF8Parallel (struct BNDATA* b) {
+	BN_TranscodeParallel (b -> utf16le, b -> nutf16, 2, b, EN_UTF16LeToUTF8Parallel);
+}
+
+static void BN_Base64Encode (struct BNDATA* b) {
+	struct ENCBASE64 e;
+	struct ENCSTREAM in, out;
+
+	EN_InitBase64 (&e, B64_STANDARD, TRUE);
+	EN_InitStream (&in, b -> utf8, b -> nutf8);
+	EN_InitStream (&out, b -> out, b -> nout);
+	EN_Base64Encode (&e, &in, &out);
+	EN_Base64EncodeFinish (&e, &out);
+	Sink = out.index;
+}
+
+static void BN_Base64Decode (struct BNDATA* b) {
+	struct ENCBASE64 e;
+	struct ENCSTREAM in, out;
+
+	EN_InitBase64 (&e, B64_STANDARD, TRUE);
+	EN_InitStream (&in, b -> base64, b -> nbase64);
+	EN_InitStream (&out, b -> out, b -> nout);
+	EN_Base64Decode (&e, &in, &out);
+	EN_Base64DecodeFinish (&e, &out);
+	Sink = out.index;
+}
+
+static void BN_HexEncode (struct BNDATA* b) {
+	struct ENCSTREAM in, out;
+
+	EN_InitStream (&in, b -> utf8, b -> nutf8);
+	EN_InitStream (&out, b -> out, b -> nout);
+	EN_HexEncode (&in, &out, FALSE);
+	Sink = out.index;
+}
+
+static void BN_HexDecode (struct BNDATA* b) {
+	struct ENCSTREAM in, out;
+
+	EN_InitStream (&in, b -> hex, 2 * b -> nutf8);
+	EN_InitStream (&out, b -> out, b -> nout);
+	EN_HexDecode (&in, &out);
+	Sink = out.index;
+}
+
+/*
+	Case insensitive comparison of the corpus with itself, which goes all the
+	way to the end.
+*/
+static void BN_CaseFoldCompare (struct BNDATA* b) {
+	Sink = (unsigned int) EN_CaseFoldCompare (b -> utf8, b -> nutf8, b -> utf8, b -> nutf8);
+}
+
+static void BN_CaseFoldHash (struct BNDATA* b) {
+	Sink = (unsigned int) EN_CaseFoldHash (b -> utf8, b -> nutf8);
+}
+
+/*
+	Needle for EN_Find(): the last characters of the corpus, about 16 bytes,
+	so that the whole text is searched.
+*/
+static void BN_Find (struct BNDATA* b, BOOL fold) {
+	unsigned int k, at, length;
+
+	k = b -> nutf8 < 16 ? 0 : b -> nutf8 - 16;
+	while ((k < b -> nutf8) && ((b -> utf8[k] & 0xC0) == 0x80))
+		k++;
+	EN_Find (b -> utf8, b -> nutf8, b -> utf8 + k, b -> nutf8 - k, fold, &at, &length);
+	Sink = at + length;
+}
+
+static void BN_FindExact (struct BNDATA* b) {
+	BN_Find (b, FALSE);
+}
+
+static void BN_FindFolded (struct BNDATA* b) {
+	BN_Find (b, TRUE);
+}
+
+static void BN_QuickCheckNFC (struct BNDATA* b) {
+	unsigned int prefix;
+
+	Sink = EN_QuickCheck (NORM_NFC, b -> utf8, b -> nutf8, &prefix) + prefix;
+}
+
+static void BN_NormalizeNFC (struct BNDATA* b) {
+	struct ENCSTREAM in, out;
+
+	EN_InitStream (&in, b -> utf8, b -> nutf8);
+	EN_InitStream (&out, b -> out, b -> nout);
+	EN_Normalize (NORM_NFC, &in, &out);
+	Sink = out.index;
+}
+
+static void BN_NormalizeNFD (struct BNDATA* b) {
+	struct ENCSTREAM in, out;
+
+	EN_InitStream (&in, b -> utf8, b -> nutf8);
+	EN_InitStream (&out, b -> out, b -> nout);
+	EN_Normalize (NORM_NFD, &in, &out);
+	Sink = out.index;
+}
+
+static void BN_UTF8CountChars (struct BNDATA* b) {
+	Sink = EN_UTF8CountChars (b -> utf8, b -> nutf8);
+}
+
+static void BN_UTF8CountUTF16 (struct BNDATA* b) {
+	Sink = EN_UTF8CountUTF16 (b -> utf8, b -> nutf8);
+}
+
+static void BN_UTF16LeCountUTF8 (struct BNDATA* b) {
+	Sink = EN_UTF16LeCountUTF8 (b -> utf16le, b -> nutf16);
+}
+
+static void BN_UTF16BeCountUTF8 (struct BNDATA* b) {
+	Sink = EN_UTF16BeCountUTF8 (b -> utf16be, b -> nutf16);
+}
+
+static void BN_UCS4CountUTF8 (struct BNDATA* b) {
+	Sink = EN_UCS4CountUTF8 (b -> ucs4, b -> nucs4);
+}
+
+static void BN_ToNativeOrder16 (struct BNDATA* b) {
+	Sink = EN_ToNativeOrder (ENC_UTF16BE, b -> utf16be, b -> nutf16, b -> out);
+}
+
+static void BN_ToNativeOrder32 (struct BNDATA* b) {
+	Sink = EN_ToNativeOrder (ENC_UCS4BE, b -> ucs4be, b -> nucs4 * sizeof (UCS4), b -> out);
+}
+
+static void BN_ReadUCS4Buffer (struct BNDATA* b) {
+	struct ENCSTREAM s;
+	unsigned int n;
+
+	EN_InitStream (&s, b -> ucs4be, b -> nucs4 * sizeof (UCS4));
+	n = 0;
+	while (s.index < s.size) {
+		n += EN_ReadUCS4Buffer (&s, ENC_UCS4BE, (UCS4*) b -> out, b -> nout / sizeof (UCS4));
+		if (s.eob)
+			break;
+		s.index += sizeof (UCS4);
+	}
+	Sink = n;
+}
+
+/*
+	Streaming decoder fed with the whole corpus as a single chunk.
+*/
+static void BN_DecoderReadBuffer (struct BNDATA* b) {
+	struct ENCDECODER d;
+	struct ENCSTREAM s;
+	unsigned int n;
+
+	EN_InitDecoder (&d, ENC_UTF8);
+	EN_InitStream (&s, b -> utf8, b -> nutf8);
+	n = 0;
+	while (s.index < s.size) {
+		n += EN_DecoderReadBuffer (&d, &s, (UCS4*) b -> out, b -> nout / sizeof (UCS4));
+		if (s.eob)
+			break;
+		s.index++;
+	}
+	EN_DecoderFinish (&d);
+	Sink = n;
+}
+
+static void BN_DetectEncoding (struct BNDATA* b) {
+	unsigned int c;
+
+	Sink = EN_DetectEncoding (b -> utf16le, b -> nutf16, &c);
+}
+
+static const struct BNFUNC FUNCS[] = {
+	{"EN_UTF8ToUCS4", IN_UTF8, BN_UTF8ToUCS4, FALSE},
+	{"EN_UTF16LeToUCS4", IN_UTF16LE, BN_UTF16LeToUCS4, FALSE},
+	{"EN_UTF16BeToUCS4", IN_UTF16BE, BN_UTF16BeToUCS4, FALSE},
+	{"EN_ReadUCS4Be", IN_UCS4BE, BN_ReadUCS4Be, FALSE},
+	{"EN_UCS4ToUTF8", IN_UCS4, BN_UCS4ToUTF8, FALSE},
+	{"EN_UCS4ToUTF16", IN_UCS4, BN_UCS4ToUTF16, FALSE},
+	{"EN_UTF8ToUTF16Le", IN_UTF8, BN_UTF8ToUTF16Le, FALSE},
+	{"EN_UTF8ToUTF16Be", IN_UTF8, BN_UTF8ToUTF16Be, FALSE},
+	{"EN_UTF16LeToUTF8", IN_UTF16LE, BN_UTF16LeToUTF8, FALSE},
+	{"EN_UTF16BeToUTF8", IN_UTF16BE, BN_UTF16BeToUTF8, FALSE},
+	{"EN_UTF8ToUTF16LeLossy", IN_UTF8, BN_UTF8ToUTF16LeLossy, FALSE},
+	{"EN_UTF16LeToUTF8Lossy", IN_UTF16LE, BN_UTF16LeToUTF8Lossy, FALSE},
+	{"EN_UTF8ToUTF16LeParallel", IN_UTF8, BN_UTF8ToUTF16LeParallel, TRUE},
+	{"EN_UTF16LeToUTF8Parallel", IN_UTF16LE, BN_UTF16LeToUTF8Parallel, TRUE},
+	{"EN_SingleByteToUTF8/LATIN1", IN_LATIN1, BN_Latin1ToUTF8, FALSE},
+	{"EN_SingleByteToUTF16Le/LATIN1", IN_LATIN1, BN_Latin1ToUTF16Le, FALSE},
+	{"EN_UTF8ToSingleByte/LATIN1", IN_UTF8, BN_UTF8ToLatin1, FALSE},
+	{"EN_UTF16LeToSingleByte/LATIN1", IN_UTF16LE, BN_UTF16LeToLatin1, FALSE},
+	{"EN_Base64Encode", IN_UTF8, BN_Base64Encode, FALSE},
+	{"EN_Base64Decode", IN_BASE64, BN_Base64Decode, FALSE},
+	{"EN_HexEncode", IN_UTF8, BN_HexEncode, FALSE},
+	{"EN_HexDecode", IN_HEX, BN_HexDecode, FALSE},
+	{"EN_CaseFoldCompare", IN_UTF8, BN_CaseFoldCompare, FALSE},
+	{"EN_CaseFoldHash", IN_UTF8, BN_CaseFoldHash, FALSE},
+	{"EN_Find", IN_UTF8, BN_FindExact, TRUE},
+	{"EN_Find/fold", IN_UTF8, BN_FindFolded, TRUE},
+	{"EN_QuickCheck/NFC", IN_UTF8, BN_QuickCheckNFC, FALSE},
+	{"EN_Normalize/NFC", IN_UTF8, BN_NormalizeNFC, TRUE},
+	{"EN_Normalize/NFD", IN_UTF8, BN_NormalizeNFD, TRUE},
+	{"EN_UTF8CountChars", IN_UTF8, BN_UTF8CountChars, FALSE},
+	{"EN_UTF8CountUTF16", IN_UTF8, BN_UTF8CountUTF16, FALSE},
+	{"EN_UTF16LeCountUTF8", IN_UTF16LE, BN_UTF16LeCountUTF8, FALSE},
+	{"EN_UTF16BeCountUTF8", IN_UTF16BE, BN_UTF16BeCountUTF8, FALSE},
+	{"EN_UCS4CountUTF8", IN_UCS4, BN_UCS4CountUTF8, FALSE},
+	{"EN_ToNativeOrder/UTF16BE", IN_UTF16BE, BN_ToNativeOrder16, FALSE},
+	{"EN_ToNativeOrder/UCS4BE", IN_UCS4BE, BN_ToNativeOrder32, FALSE},
+	{"EN_ReadUCS4Buffer", IN_UCS4BE, BN_ReadUCS4Buffer, FALSE},
+	{"EN_DecoderReadBuffer", IN_UTF8, BN_DecoderReadBuffer, FALSE},
+	{"EN_DetectEncoding", IN_UTF16LE, BN_DetectEncoding, FALSE}};
+
+#define FUNC_COUNT (sizeof (FUNCS) / sizeof (FUNCS[0]))
+
+static double BN_Now (void) {
+	struct timespec t;
+
+	clock_gettime (CLOCK_MONOTONIC, &t);
+
+	return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+static unsigned int BN_InputSize (struct BNDATA* b, const struct BNFUNC* f) {
+	switch (f -> input) {
+		case IN_UTF8:
+			return b -> nutf8;
+		case IN_UTF16LE:
+		case IN_UTF16BE:
+			return f -> run == BN_DetectEncoding && b -> nutf16 > EN_DETECT_SAMPLE ? EN_DETECT_SAMPLE : b -> nutf16;
+		case IN_LATIN1:
+			return b -> nucs4;
+		case IN_BASE64:
+			return b -> nbase64;
+		case IN_HEX:
+			return 2 * b -> nutf8;
+		default:
+			return b -> nucs4 * sizeof (UCS4);
+	}
+}
+
+/*
+	Runs "f" until "mintime" seconds have gone by and prints a result line.
+*/
+static void BN_Measure (const char* isa, const struct BNFUNC* f, enum BNCORPUS corpus, unsigned int size,
+			struct BNDATA* b, double mintime) {
+	unsigned long long it, k;
+	double t0, t;
+	unsigned int n;
+
+	// Warm up caches and the page tables of the output buffer.
+	f -> run (b);
+	it = 0;
+	k = 1;
+	t0 = BN_Now ();
+	do {
+		for (; it < k; it++)
+			f -> run (b);
+		k *= 2;
+	} while ((t = BN_Now () - t0) < mintime);
+	n = BN_InputSize (b, f);
+	printf ("%s,%s,%s,%u,%u,%llu,%.6f,%.3f\n", isa, f -> name, CORPUSNAMES[corpus], size, n, it, t,
+			(double) n * (double) it / t / 1e9);
+	fflush (stdout);
+}
+
+/*
+	Parses a size with an optional K, M or G suffix.
+*/
+static unsigned int BN_ParseSize (const char* s) {
+	unsigned long v;
+	char* e;
+
+	v = strtoul (s, &e, 10);
+	switch (*e) {
+		case 'k': case 'K': v <<= 10; break;
+		case 'm': case 'M': v <<= 20; break;
+		case 'g': case 'G': v <<= 30; break;
+	}
+
+	return (unsigned int) v;
+}
+
+int main (int argc, char** argv) {
+	unsigned int sizes[BN_MAX_SIZES], nsizes, s, f;
+	const char *isa, *corpus, *func;
+	struct BNDATA b;
+	double mintime;
+	int i, c, k;
+	enum ENISA saved;
+
+	mintime = 0.2;
+	nsizes = 0;
+	isa = corpus = func = NULL;
+	for (i = 1; i < argc; i++) {
+		if ((argv[i][0] != '-') || (i + 1 >= argc)) {
+			fprintf (stderr, "usage: %s [-t seconds] [-s bytes] [-i isa] [-c corpus] [-f function]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+		switch (argv[i][1]) {
+			case 't': mintime = atof (argv[++i]); break;
+			case 's':
+				if (nsizes < BN_MAX_SIZES)
+					sizes[nsizes++] = BN_ParseSize (argv[++i]);
+				break;
+			case 'i': isa = argv[++i]; break;
+			case 'c': corpus = argv[++i]; break;
+			case 'f': func = argv[++i]; break;
+			default:
+				fprintf (stderr, "%s: unknown option %s\n", argv[0], argv[i]);
+				return EXIT_FAILURE;
+		}
+	}
+	if (nsizes == 0) {
+		sizes[nsizes++] = 1 << 10;
+		sizes[nsizes++] = 64 << 10;
+		sizes[nsizes++] = 1 << 20;
+		sizes[nsizes++] = 16 << 20;
+	}
+	saved = EN_GetISA ();
+	printf ("isa,function,corpus,size,bytes,iterations,seconds,gbps\n");
+	for (c = 0; c < CO_COUNT; c++) {
+		if (corpus && strcmp (corpus, CORPUSNAMES[c]))
+			continue;
+		for (s = 0; s < nsizes; s++) {
+			BN_Generate (&b, (enum BNCORPUS) c, sizes[s]);
+			for (k = ISA_SCALAR; k <= ISA_AVX512; k++) {
+				if ((isa && strcmp (isa, ISANAMES[k])) || !EN_SetISA ((enum ENISA) k))
+					continue;
+				for (f = 0; f < FUNC_COUNT; f++)
+					if ((!func || !strcmp (func, FUNCS[f].name)) && !(FUNCS[f].validonly && (c == CO_INVALID)))
+						BN_Measure (ISANAMES[k], &FUNCS[f], (enum BNCORPUS) c, sizes[s], &b, mintime);
+			}
+			BN_Free (&b);
+		}
+	}
+	EN_SetISA (saved);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,265 @@
+/*
+	File: enccodec.h
+	Creation: 19-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Header only per character codecs specialized by encoding. The byte
+		order is an argument of inline functions, and every caller passes a
+		constant, so it's folded away and each encoding gets its own kernel
+		with no swap flag or switch left at run time. Bytes are put together
+		with shifts, which needs no ARCH_BIG_ENDIAN or ARCH_LITTLE_ENDIAN: the
+		compiler turns them into plain or byte swapping loads.
+
+		The C readers of encoding.c are wrappers over these. For C++ there are
+		templates on the encodings, ENCodec and EN_Transcode(), which compile
+		every pair into its own loop.
+*/
+
+#ifndef ENCCODEC_H
+#define ENCCODEC_H
+
+#include "enciter.h"
+
+/*
+	Gets a UCS-4 character from "s" with the byte order of "e", one of the
+	ENC_UCS4* encodings. The unusual orders are named after the significance
+	of their bytes, 1 for the most significant: 3412 is big-endian and 2143
+	little-endian with the halves swapped, which compilers see as a rotation.
+*/
+static inline UCS4 EN_LoadUCS4 (const BYTE* s, enum ENCODING e) {
+	UCS4 c;
+
+	if ((e == ENC_UCS4BE) || (e == ENC_UCS4UOO3412))
+		c = (UCS4) s[0] << 24 | (UCS4) s[1] << 16 | (UCS4) s[2] << 8 | s[3];
+	else
+		c = (UCS4) s[3] << 24 | (UCS4) s[2] << 16 | (UCS4) s[1] << 8 | s[0];
+	if ((e == ENC_UCS4UOO3412) || (e == ENC_UCS4UOO2143))
+		c = c >> 16 | c << 16;
+
+	return c;
+}
+
+/*
+	Puts "c" on "d" with the byte order of "e", as EN_LoadUCS4() reads it.
+*/
+static inline void EN_StoreUCS4 (BYTE* d, UCS4 c, enum ENCODING e) {
+	if ((e == ENC_UCS4UOO3412) || (e == ENC_UCS4UOO2143))
+		c = c >> 16 | c << 16;
+	if ((e == ENC_UCS4BE) || (e == ENC_UCS4UOO3412)) {
+		d[0] = (BYTE) (c >> 24);
+		d[1] = (BYTE) (c >> 16);
+		d[2] = (BYTE) (c >> 8);
+		d[3] = (BYTE) c;
+	} else {
+		d[0] = (BYTE) c;
+		d[1] = (BYTE) (c >> 8);
+		d[2] = (BYTE) (c >> 16);
+		d[3] = (BYTE) (c >> 24);
+	}
+}
+
+/*
+	Decodes a character from UTF-16 stream "s" (RFC 2781).
+
+	[Return]
+
+		"TRUE" if no error was found, "FALSE" in other case, with "eob" set if
+		the stream ends inside the character. "index" is left on the failed
+		code unit.
+*/
+static inline BOOL EN_DecodeUTF16 (struct ENCSTREAM* s, UCS4* c, BOOL be) {
+	WORD w1, w2;
+
+	if (s -> size - s -> index < 2) {
+		s -> eob = TRUE;
+		return FALSE;
+	}
+	w1 = EN_GetUTF16 (s -> buffer + s -> index, be);
+	if ((w1 < 0xD800) || (w1 > 0xDFFF)) {
+		*c = (UCS4) w1;
+		s -> index += 2;
+		return TRUE;
+	}
+	// A low surrogate can't go first.
+	if (w1 > 0xDBFF)
+		return FALSE;
+	if (s -> size - s -> index < 4) {
+		s -> eob = TRUE;
+		return FALSE;
+	}
+	w2 = EN_GetUTF16 (s -> buffer + s -> index + 2, be);
+	if ((w2 < 0xDC00) || (w2 > 0xDFFF))
+		return FALSE;
+	*c = 0x10000 + ((UCS4) (w1 & 0x03FF) << 10 | (UCS4) (w2 & 0x03FF));
+	s -> index += 4;
+
+	return TRUE;
+}
+
+/*
+	Decodes a character from UCS-4 stream "s" on byte order "e". Values above
+	0x7FFFFFFF are refused.
+*/
+static inline BOOL EN_DecodeUCS4 (struct ENCSTREAM* s, UCS4* c, enum ENCODING e) {
+	if (s -> size - s -> index < 4) {
+		s -> eob = TRUE;
+		return FALSE;
+	}
+	*c = EN_LoadUCS4 (s -> buffer + s -> index, e);
+	if (*c > 0x7FFFFFFF)
+		return FALSE;
+	s -> index += 4;
+
+	return TRUE;
+}
+
+/*
+	Encodes "c" on UTF-16 stream "s", as a surrogate pair above 0xFFFF.
+	FALSE for surrogates and values above 0x10FFFF, and with "eob" set if there
+	is no room.
+*/
+static inline BOOL EN_EncodeUTF16 (UCS4 c, struct ENCSTREAM* s, BOOL be) {
+	BYTE* d;
+	WORD w;
+	unsigned int by;
+
+	if ((c > 0x10FFFF) || ((c >= 0xD800) && (c <= 0xDFFF)))
+		return FALSE;
+	by = c < 0x10000 ? 2 : 4;
+	if ((s -> size - s -> index < by) && !EN_ReserveStream (s, by)) {
+		s -> eob = TRUE;
+		return FALSE;
+	}
+	d = s -> buffer + s -> index;
+	if (c < 0x10000) {
+		w = (WORD) c;
+		s -> index += 2;
+	} else {
+		c -= 0x10000;
+		w = (WORD) (0xD800 | c >> 10);
+		c = 0xDC00 | (c & 0x03FF);
+		d[be ? 2 : 3] = (BYTE) (c >> 8);
+		d[be ? 3 : 2] = (BYTE) c;
+		s -> index += 4;
+	}
+	d[be ? 0 : 1] = (BYTE) (w >> 8);
+	d[be ? 1 : 0] = (BYTE) w;
+
+	return TRUE;
+}
+
+/*
+	Encodes "c" on UCS-4 stream "s" on byte order "e". FALSE above 0x7FFFFFFF,
+	and with "eob" set if there is no room.
+*/
+static inline BOOL EN_EncodeUCS4 (UCS4 c, struct ENCSTREAM* s, enum ENCODING e) {
+	if (c > 0x7FFFFFFF)
+		return FALSE;
+	if ((s -> size - s -> index < 4) && !EN_ReserveStream (s, 4)) {
+		s -> eob = TRUE;
+		return FALSE;
+	}
+	EN_StoreUCS4 (s -> buffer + s -> index, c, e);
+	s -> index += 4;
+
+	return TRUE;
+}
+
+/*
+	Decodes a character of encoding "e" from "s". Called with a constant "e"
+	it's just the decoder of that encoding.
+*/
+static inline BOOL EN_DecodeAs (struct ENCSTREAM* s, UCS4* c, enum ENCODING e) {
+	switch (e) {
+		case ENC_UTF8:
+			return EN_UTF8ToUCS4 (s, c);
+		case ENC_UTF16LE:
+		case ENC_UTF16BE:
+			return EN_DecodeUTF16 (s, c, e == ENC_UTF16BE);
+		case ENC_UCS4LE:
+		case ENC_UCS4BE:
+		case ENC_UCS4UOO3412:
+		case ENC_UCS4UOO2143:
+			return EN_DecodeUCS4 (s, c, e);
+		case ENC_LATIN1:
+			return EN_ReadLatin1 (s, c);
+		case ENC_CP1252:
+			return EN_ReadCP1252 (s, c);
+		case ENC_ASCII:
+			return EN_ReadASCII (s, c);
+		default:
+			return FALSE;
+	}
+}
+
+/*
+	Encodes "c" on "s" with encoding "e", as EN_DecodeAs() decodes.
+*/
+static inline BOOL EN_EncodeAs (UCS4 c, struct ENCSTREAM* s, enum ENCODING e) {
+	switch (e) {
+		case ENC_UTF8:
+			return EN_UCS4ToUTF8 (c, s);
+		case ENC_UTF16LE:
+		case ENC_UTF16BE:
+			return EN_EncodeUTF16 (c, s, e == ENC_UTF16BE);
+		case ENC_UCS4LE:
+		case ENC_UCS4BE:
+		case ENC_UCS4UOO3412:
+		case ENC_UCS4UOO2143:
+			return EN_EncodeUCS4 (c, s, e);
+		case ENC_LATIN1:
+			return EN_UCS4ToLatin1 (c, s);
+		case ENC_CP1252:
+			return EN_UCS4ToCP1252 (c, s);
+		case ENC_ASCII:
+			return EN_UCS4ToASCII (c, s);
+		default:
+			return FALSE;
+	}
+}
+
+#ifdef __cplusplus
+
+/*
+	Codec of encoding "E", for code generic on the encoding:
+
+		ENCodec<ENC_UCS4BE>::Decode (s, &c)
+*/
+template <enum ENCODING E>
+struct ENCodec {
+	static const enum ENCODING encoding = E;
+
+	static BOOL Decode (struct ENCSTREAM* s, UCS4* c) { return EN_DecodeAs (s, c, E); }
+	static BOOL Encode (UCS4 c, struct ENCSTREAM* s) { return EN_EncodeAs (c, s, E); }
+};
+
+/*
+	Transcodes "in", on encoding "IN", onto "out" on encoding "OUT", one
+	character at a time, with a loop of its own for every pair. It fails as
+	the buffer transcoders do: with "in -> eob" set if the input ends inside a
+	character, "out -> eob" if there is no room, and alone on malformed input
+	or a character "OUT" lacks. "in -> index" is left on the character that
+	failed.
+*/
+template <enum ENCODING IN, enum ENCODING OUT>
+BOOL EN_Transcode (struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	unsigned int i;
+	UCS4 c;
+
+	while (in -> index < in -> size) {
+		i = in -> index;
+		if (!ENCodec<IN>::Decode (in, &c))
+			return FALSE;
+		if (!ENCodec<OUT>::Encode (c, out)) {
+			in -> index = i;
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+#endif
+
+#endif
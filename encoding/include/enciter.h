@@ -0,0 +1,273 @@
+/*
+	File: enciter.h
+	Creation: 19-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Header only character iterators over UTF-8 and UTF-16 buffers. They
+		decode straight from a byte range with no stream or call in between, so
+		a loop over the characters of a text gets the ASCII path inlined in
+		place. For C++ there are ranges for range-based for loops as well.
+*/
+
+#ifndef ENCITER_H
+#define ENCITER_H
+
+#include "encoding.h"
+
+// Iterator over the characters of a buffer. "p" is the next sequence and
+// "end" the end of the buffer. "error" is set when a malformed sequence stops
+// the iteration (only with POL_STRICT), and "p" is left on it.
+struct ENCITER {
+	const BYTE* p;
+	const BYTE* end;
+	enum ENPOLICY policy;
+	BOOL error;
+};
+
+/*
+	Gets a UTF-16 code unit from "s" with the requested byte order.
+*/
+static inline WORD EN_GetUTF16 (const BYTE* s, BOOL be) {
+	if (be)
+		return (WORD) (s[0] << 8 | s[1]);
+
+	return (WORD) (s[1] << 8 | s[0]);
+}
+
+/*
+	Range of the second byte of a sequence that starts with lead byte "c", which
+	excludes overlong forms, surrogates and values above 0x10FFFF.
+*/
+static inline void EN_UTF8SecondRange (BYTE c, BYTE* lo, BYTE* hi) {
+	*lo = 0x80;
+	*hi = 0xBF;
+	switch (c) {
+		case 0xE0: *lo = 0xA0; break;
+		case 0xED: *hi = 0x9F; break;
+		case 0xF0: *lo = 0x90; break;
+		case 0xF4: *hi = 0x8F; break;
+	}
+}
+
+/*
+	Decodes one UTF-8 sequence of 2 to 4 bytes (RFC 3629).
+
+	[Params]
+
+		s: first byte of the sequence.
+		n: bytes available from "s".
+		c: decoded character.
+
+	[Return]
+
+		The sequence length, 0 if the sequence is malformed or -1 if the available
+		bytes are a valid but incomplete prefix.
+*/
+static inline int EN_DecodeUTF8Seq (const BYTE* s, unsigned int n, UCS4* c) {
+	BYTE lo, hi;
+	int by, i;
+
+	if (s[0] < 0xC2)
+		return 0;
+	else if (s[0] < 0xE0) {
+		by = 2;
+		*c = s[0] & 0x1F;
+	} else if (s[0] < 0xF0) {
+		by = 3;
+		*c = s[0] & 0x0F;
+	} else if (s[0] < 0xF5) {
+		by = 4;
+		*c = s[0] & 0x07;
+	} else
+		return 0;
+	EN_UTF8SecondRange (s[0], &lo, &hi);
+	if (n < 2)
+		return -1;
+	if ((s[1] < lo) || (s[1] > hi))
+		return 0;
+	*c = *c << 6 | (s[1] & 0x3F);
+	for (i = 2; i < by; i++) {
+		if ((unsigned int) i >= n)
+			return -1;
+		if ((s[i] & 0xC0) != 0x80)
+			return 0;
+		*c = *c << 6 | (s[i] & 0x3F);
+	}
+
+	return by;
+}
+
+/*
+	Returns the length of the maximal subpart of a malformed UTF-8 sequence:
+	the longest prefix of a valid sequence, or 1 if "s[0]" can't start one.
+	Every maximal subpart is replaced by a single U+FFFD (Unicode chapter 3,
+	"U+FFFD Substitution of Maximal Subparts", as the WHATWG decoder does).
+*/
+static inline unsigned int EN_UTF8Subpart (const BYTE* s, unsigned int n) {
+	unsigned int by, i;
+	BYTE lo, hi;
+
+	if ((s[0] < 0xC2) || (s[0] > 0xF4))
+		return 1;
+	by = s[0] < 0xE0 ? 2 : s[0] < 0xF0 ? 3 : 4;
+	EN_UTF8SecondRange (s[0], &lo, &hi);
+	if ((n < 2) || (s[1] < lo) || (s[1] > hi))
+		return 1;
+	for (i = 2; (i < by) && (i < n) && ((s[i] & 0xC0) == 0x80); i++)
+		;
+
+	return i;
+}
+
+/*
+	Prepares "it" to iterate over the "n" bytes of "s".
+*/
+static inline void EN_InitIter (struct ENCITER* it, const BYTE* s, unsigned int n, enum ENPOLICY policy) {
+	it -> p = s;
+	it -> end = s + n;
+	it -> policy = policy;
+	it -> error = FALSE;
+}
+
+/*
+	Sequences of EN_IterUTF8() other than ASCII. A sequence cut by the end of
+	the buffer is malformed, as the buffer is supposed to hold the whole text.
+*/
+static inline BOOL EN_IterUTF8Seq (struct ENCITER* it, UCS4* c) {
+	unsigned int n;
+	int by;
+
+	n = (unsigned int) (it -> end - it -> p);
+	if ((by = EN_DecodeUTF8Seq (it -> p, n, c)) > 0) {
+		it -> p += by;
+		return TRUE;
+	}
+	if (it -> policy == POL_REPLACE) {
+		*c = 0xFFFD;
+		it -> p += EN_UTF8Subpart (it -> p, n);
+		return TRUE;
+	}
+	it -> error = TRUE;
+
+	return FALSE;
+}
+
+/*
+	Gets the next character of a UTF-8 buffer.
+
+	[Params]
+
+		it: iterator.
+		c: decoded character.
+
+	[Return]
+
+		FALSE at the end of the buffer or on a malformed sequence ("it -> error"
+		tells them apart), TRUE otherwise.
+*/
+static inline BOOL EN_IterUTF8 (struct ENCITER* it, UCS4* c) {
+	if (it -> p == it -> end)
+		return FALSE;
+	if (*it -> p < 0x80) {
+		*c = *it -> p++;
+		return TRUE;
+	}
+
+	return EN_IterUTF8Seq (it, c);
+}
+
+/*
+	Gets the next character of a UTF-16 buffer with the requested byte order.
+	Unpaired surrogates and an odd last byte are malformed. Same return as
+	EN_IterUTF8().
+*/
+static inline BOOL EN_IterUTF16 (struct ENCITER* it, UCS4* c, BOOL be) {
+	unsigned int n;
+	WORD w1, w2;
+
+	n = (unsigned int) (it -> end - it -> p);
+	if (n == 0)
+		return FALSE;
+	if (n >= 2) {
+		w1 = EN_GetUTF16 (it -> p, be);
+		if ((w1 < 0xD800) || (w1 > 0xDFFF)) {
+			*c = w1;
+			it -> p += 2;
+			return TRUE;
+		}
+		if ((w1 <= 0xDBFF) && (n >= 4)) {
+			w2 = EN_GetUTF16 (it -> p + 2, be);
+			if ((w2 >= 0xDC00) && (w2 <= 0xDFFF)) {
+				*c = 0x10000 + ((UCS4) (w1 - 0xD800) << 10) + (w2 - 0xDC00);
+				it -> p += 4;
+				return TRUE;
+			}
+		}
+	}
+	if (it -> policy == POL_REPLACE) {
+		// A high surrogate cut by the end of the buffer goes with what's left
+		// of it, the same as an odd last byte.
+		*c = 0xFFFD;
+		if ((n < 2) || ((n < 4) && (w1 <= 0xDBFF)))
+			it -> p = it -> end;
+		else
+			it -> p += 2;
+		return TRUE;
+	}
+	it -> error = TRUE;
+
+	return FALSE;
+}
+
+static inline BOOL EN_IterUTF16Le (struct ENCITER* it, UCS4* c) {
+	return EN_IterUTF16 (it, c, FALSE);
+}
+
+static inline BOOL EN_IterUTF16Be (struct ENCITER* it, UCS4* c) {
+	return EN_IterUTF16 (it, c, TRUE);
+}
+
+#ifdef __cplusplus
+
+/*
+	Range over the characters of a buffer, for range-based for loops:
+
+		for (UCS4 c : ENUTF8Range (s, n))
+			...
+
+	It stops on the first malformed sequence unless "policy" is POL_REPLACE.
+*/
+template <BOOL (*NEXT) (struct ENCITER*, UCS4*)>
+class ENRange {
+public:
+	class iterator {
+	public:
+		iterator () : it (), c (0), done (true) {}
+		explicit iterator (const struct ENCITER& i) : it (i), c (0), done (false) { ++*this; }
+		UCS4 operator* () const { return c; }
+		iterator& operator++ () { done = !NEXT (&it, &c); return *this; }
+		// Only the end of the range and the position past the current character
+		// matter.
+		bool operator== (const iterator& o) const { return done ? o.done : !o.done && (it.p == o.it.p); }
+		bool operator!= (const iterator& o) const { return !(*this == o); }
+	private:
+		struct ENCITER it;
+		UCS4 c;
+		bool done;
+	};
+
+	ENRange (const BYTE* s, unsigned int n, enum ENPOLICY policy = POL_STRICT) { EN_InitIter (&it, s, n, policy); }
+	iterator begin () const { return iterator (it); }
+	iterator end () const { return iterator (); }
+private:
+	struct ENCITER it;
+};
+
+typedef ENRange<EN_IterUTF8> ENUTF8Range;
+typedef ENRange<EN_IterUTF16Le> ENUTF16LeRange;
+typedef ENRange<EN_IterUTF16Be> ENUTF16BeRange;
+
+#endif
+
+#endif
@@ -13,10 +13,39 @@
 #include "defs.h"
 
 #define MAX_UTF8_BYTES 6
+// Bytes looked at by EN_DetectEncoding().
+#define EN_DETECT_SAMPLE 4096
+// Characters (and bytes) between entries of a code point index.
+#define EN_CPINDEX_STRIDE 512
 
 // In accordance with XML recomendation 1.1, all XML processors must accept UTF-8 and
-// UTF-16 encodings of Unicode.
-enum ENCODING {ENC_UNKNOWN, ENC_UTF8, ENC_UTF16LE, ENC_UTF16BE, ENC_UCS4LE, ENC_UCS4BE, ENC_UCS4UOO3412, ENC_UCS4UOO2143};
+// UTF-16 encodings of Unicode. The single byte charsets go last: ISO-8859-1,
+// Windows-1252 (as WHATWG maps it, its 5 unused bytes are C1 controls) and
+// US-ASCII.
+enum ENCODING {ENC_UNKNOWN, ENC_UTF8, ENC_UTF16LE, ENC_UTF16BE, ENC_UCS4LE, ENC_UCS4BE, ENC_UCS4UOO3412, ENC_UCS4UOO2143,
+		ENC_LATIN1, ENC_CP1252, ENC_ASCII};
+
+// Instruction sets with encoding kernels, from the least to the most capable.
+enum ENISA {ISA_SCALAR, ISA_SSE2, ISA_AVX2, ISA_AVX512};
+
+// What decoders do with malformed input.
+// POL_STRICT: stop and report it.
+// POL_REPLACE: put U+FFFD in place of every maximal subpart and go on.
+enum ENPOLICY {POL_STRICT, POL_REPLACE};
+
+// Base64 alphabets (RFC 4648). B64_STANDARD ends in '+' and '/', B64_URL in
+// '-' and '_'.
+enum ENB64 {B64_STANDARD, B64_URL};
+
+// Unicode normalization forms (UAX #15): canonical composition and canonical
+// decomposition.
+enum ENNORM {NORM_NFC, NORM_NFD};
+
+// Normalization quick check answers.
+// QC_YES: the text is in the form.
+// QC_NO: it isn't.
+// QC_MAYBE: it can't be told without normalizing it.
+enum ENQC {QC_YES, QC_NO, QC_MAYBE};
 
 typedef unsigned int UCS4;
 typedef unsigned int UTF16;
@@ -29,15 +58,69 @@ typedef unsigned int UTF16;
 // less significant byte.
 typedef BYTE UTF8[MAX_UTF8_BYTES];
 
+// Memory functions for growing streams. "ctx" is passed back to them.
+struct ENCALLOCATOR {
+	void* (*realloc) (void* ctx, void* p, unsigned long size);
+	void (*free) (void* ctx, void* p);
+	void* ctx;
+};
+
+// Byte stream for input or output. On input "size" is the data length, on
+// output the buffer capacity. An output stream with "grow" set reallocates its
+// buffer when full (doubling it) instead of setting "eob", with "allocator",
+// or realloc() and free() if it is NULL. Streams set up by hand must clear
+// "grow", EN_InitStream() does it.
 struct ENCSTREAM {
 	BYTE* buffer;
 	unsigned int index;
 	unsigned int size;
 	BOOL eob;
+	BOOL grow;
+	const struct ENCALLOCATOR* allocator;
+};
+
+// Incremental decoder state. "pending" holds the start of a sequence cut by
+// the end of the previous chunk.
+struct ENCDECODER {
+	enum ENCODING encoding;
+	enum ENPOLICY policy;
+	BYTE pending[MAX_UTF8_BYTES];
+	BYTE npending;
+};
+
+// Base64 encoder or decoder state. "pending" holds the bytes (encoding) or
+// characters (decoding) of a group cut by the end of the previous chunk, and
+// "done" is set once a decoder has seen padding.
+struct ENCBASE64 {
+	enum ENB64 alphabet;
+	BOOL pad;
+	BOOL done;
+	BYTE pending[4];
+	BYTE npending;
+};
+
+// Sparse code point index of a UTF-8 text. "offsets[k]" is the byte offset of
+// character k * EN_CPINDEX_STRIDE and "chars[k]" the characters before byte
+// k * EN_CPINDEX_STRIDE. Covers the first "size" bytes, "length" characters.
+// Every byte that isn't a continuation byte counts as a character.
+struct ENCPINDEX {
+	unsigned int* offsets;
+	unsigned int* chars;
+	unsigned int noffsets;
+	unsigned int nchars;
+	unsigned int size;
+	unsigned int length;
 };
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct ENCSTREAM* EN_NewStream (unsigned int buffersize);
+struct ENCSTREAM* EN_NewGrowingStream (unsigned int buffersize, const struct ENCALLOCATOR* allocator);
 void EN_FreeStream (struct ENCSTREAM* s);
+void EN_InitStream (struct ENCSTREAM* s, BYTE* buffer, unsigned int size);
+BOOL EN_ReserveStream (struct ENCSTREAM* s, unsigned int n);
 enum ENCODING EN_SearchEncoding (struct ENCSTREAM* s);
 BOOL EN_UCS4ToUTF8 (UCS4 c, struct ENCSTREAM* s);
 BOOL EN_UCS4ToUTF16 (UCS4 c, struct ENCSTREAM* s);
@@ -50,4 +133,97 @@ BOOL EN_ReadUCS4Be (struct ENCSTREAM* s, UCS4* c);
 BOOL EN_ReadUCS4Uoo3412 (struct ENCSTREAM* s, UCS4* c);
 BOOL EN_ReadUCS4Uoo2143 (struct ENCSTREAM* s, UCS4* c);
 
+// Buffer transcoders (transcode.c).
+BOOL EN_UTF8ToUTF16Le (struct ENCSTREAM* in, struct ENCSTREAM* out);
+BOOL EN_UTF8ToUTF16Be (struct ENCSTREAM* in, struct ENCSTREAM* out);
+BOOL EN_UTF16LeToUTF8 (struct ENCSTREAM* in, struct ENCSTREAM* out);
+BOOL EN_UTF16BeToUTF8 (struct ENCSTREAM* in, struct ENCSTREAM* out);
+BOOL EN_UTF8ToUTF16LeLossy (struct ENCSTREAM* in, struct ENCSTREAM* out);
+BOOL EN_UTF8ToUTF16BeLossy (struct ENCSTREAM* in, struct ENCSTREAM* out);
+BOOL EN_UTF16LeToUTF8Lossy (struct ENCSTREAM* in, struct ENCSTREAM* out);
+BOOL EN_UTF16BeToUTF8Lossy (struct ENCSTREAM* in, struct ENCSTREAM* out);
+unsigned int EN_UTF8CountChars (const BYTE* s, unsigned int n);
+unsigned int EN_UTF8CountUTF16 (const BYTE* s, unsigned int n);
+unsigned int EN_UTF16LeCountUTF8 (const BYTE* s, unsigned int n);
+unsigned int EN_UTF16BeCountUTF8 (const BYTE* s, unsigned int n);
+unsigned int EN_UCS4CountUTF8 (const UCS4* s, unsigned int n);
+
+// Multi-threaded buffer transcoders (parallel.c).
+BOOL EN_UTF8ToUTF16LeParallel (struct ENCSTREAM* in, struct ENCSTREAM* out, unsigned int threads);
+BOOL EN_UTF8ToUTF16BeParallel (struct ENCSTREAM* in, struct ENCSTREAM* out, unsigned int threads);
+BOOL EN_UTF16LeToUTF8Parallel (struct ENCSTREAM* in, struct ENCSTREAM* out, unsigned int threads);
+BOOL EN_UTF16BeToUTF8Parallel (struct ENCSTREAM* in, struct ENCSTREAM* out, unsigned int threads);
+
+// Single byte charsets (singlebyte.c). "encoding" is ENC_LATIN1, ENC_CP1252 or ENC_ASCII.
+BOOL EN_ReadLatin1 (struct ENCSTREAM* s, UCS4* c);
+BOOL EN_ReadCP1252 (struct ENCSTREAM* s, UCS4* c);
+BOOL EN_ReadASCII (struct ENCSTREAM* s, UCS4* c);
+BOOL EN_UCS4ToLatin1 (UCS4 c, struct ENCSTREAM* s);
+BOOL EN_UCS4ToCP1252 (UCS4 c, struct ENCSTREAM* s);
+BOOL EN_UCS4ToASCII (UCS4 c, struct ENCSTREAM* s);
+BOOL EN_SingleByteToUTF8 (enum ENCODING encoding, struct ENCSTREAM* in, struct ENCSTREAM* out);
+BOOL EN_SingleByteToUTF16Le (enum ENCODING encoding, struct ENCSTREAM* in, struct ENCSTREAM* out);
+BOOL EN_SingleByteToUTF16Be (enum ENCODING encoding, struct ENCSTREAM* in, struct ENCSTREAM* out);
+BOOL EN_UTF8ToSingleByte (enum ENCODING encoding, struct ENCSTREAM* in, struct ENCSTREAM* out);
+BOOL EN_UTF16LeToSingleByte (enum ENCODING encoding, struct ENCSTREAM* in, struct ENCSTREAM* out);
+BOOL EN_UTF16BeToSingleByte (enum ENCODING encoding, struct ENCSTREAM* in, struct ENCSTREAM* out);
+
+// Byte order normalization (byteorder.c).
+unsigned int EN_ToNativeOrder (enum ENCODING encoding, const BYTE* s, unsigned int n, BYTE* d);
+unsigned int EN_ReadUCS4Buffer (struct ENCSTREAM* s, enum ENCODING encoding, UCS4* c, unsigned int max);
+
+// Detection without BOM (detect.c).
+enum ENCODING EN_DetectEncoding (const BYTE* s, unsigned int n, unsigned int* confidence);
+
+// Code point index (cpindex.c).
+void EN_InitCPIndex (struct ENCPINDEX* x);
+void EN_FreeCPIndex (struct ENCPINDEX* x);
+BOOL EN_ExtendCPIndex (struct ENCPINDEX* x, const BYTE* s, unsigned int n);
+BOOL EN_CPIndexToOffset (const struct ENCPINDEX* x, const BYTE* s, unsigned int index, unsigned int* offset);
+BOOL EN_CPIndexFromOffset (const struct ENCPINDEX* x, const BYTE* s, unsigned int offset, unsigned int* index);
+
+// Base64 (base64.c).
+void EN_InitBase64 (struct ENCBASE64* b, enum ENB64 alphabet, BOOL pad);
+unsigned int EN_Base64EncodedLength (unsigned int n, BOOL pad);
+BOOL EN_Base64Encode (struct ENCBASE64* b, struct ENCSTREAM* in, struct ENCSTREAM* out);
+BOOL EN_Base64EncodeFinish (struct ENCBASE64* b, struct ENCSTREAM* out);
+BOOL EN_Base64Decode (struct ENCBASE64* b, struct ENCSTREAM* in, struct ENCSTREAM* out);
+BOOL EN_Base64DecodeFinish (struct ENCBASE64* b, struct ENCSTREAM* out);
+
+// Hex (hex.c).
+BOOL EN_HexEncode (struct ENCSTREAM* in, struct ENCSTREAM* out, BOOL upper);
+BOOL EN_HexDecode (struct ENCSTREAM* in, struct ENCSTREAM* out);
+
+// Case folding (casefold.c).
+UCS4 EN_CaseFold (UCS4 c);
+int EN_CaseFoldCompare (const BYTE* a, unsigned int na, const BYTE* b, unsigned int nb);
+unsigned long long EN_CaseFoldHash (const BYTE* s, unsigned int n);
+
+// Normalization (normalize.c).
+enum ENQC EN_QuickCheck (enum ENNORM form, const BYTE* s, unsigned int n, unsigned int* prefix);
+BOOL EN_IsNormalized (enum ENNORM form, const BYTE* s, unsigned int n);
+BOOL EN_Normalize (enum ENNORM form, struct ENCSTREAM* in, struct ENCSTREAM* out);
+
+// Substring search (find.c).
+BOOL EN_Find (const BYTE* s, unsigned int n, const BYTE* needle, unsigned int m, BOOL fold, unsigned int* at,
+		unsigned int* length);
+
+// File transcoding (transfile.c).
+BOOL EN_TranscodeFile (int infd, enum ENCODING inenc, int outfd, enum ENCODING outenc);
+
+// Kernel dispatch (dispatch.c).
+enum ENISA EN_GetISA (void);
+BOOL EN_SetISA (enum ENISA isa);
+
+// Incremental decoding (decoder.c).
+void EN_InitDecoder (struct ENCDECODER* d, enum ENCODING encoding);
+void EN_SetDecoderPolicy (struct ENCDECODER* d, enum ENPOLICY policy);
+BOOL EN_DecoderRead (struct ENCDECODER* d, struct ENCSTREAM* in, UCS4* c);
+unsigned int EN_DecoderReadBuffer (struct ENCDECODER* d, struct ENCSTREAM* in, UCS4* out, unsigned int max);
+BOOL EN_DecoderFinish (struct ENCDECODER* d);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
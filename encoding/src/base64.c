@@ -0,0 +1,236 @@
+/*
+	File: base64.c
+	Creation: 19-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Base64 encoding and decoding (RFC 4648) with the standard alphabet and
+		the URL and filename safe one, on streams fed in chunks of any size.
+		Whole groups go through the kernels, and only a group cut by the end
+		of a chunk or ended by padding is handled here.
+
+		Decoding is strict: characters out of the alphabet (line breaks too),
+		misplaced or missing padding and unused bits that aren't zero are all
+		errors, so a binary value has a single valid text.
+*/
+
+#include "kernels.h"
+
+/*
+	Prepares "b" for a new text.
+
+	[Params]
+
+		b: encoder or decoder state.
+		alphabet: B64_STANDARD or B64_URL.
+		pad: encoders end the text with '=' up to a whole group and decoders
+			require it. Without it encoders leave it out and decoders reject it.
+*/
+void EN_InitBase64 (struct ENCBASE64* b, enum ENB64 alphabet, BOOL pad) {
+	b -> alphabet = alphabet;
+	b -> pad = pad;
+	b -> done = FALSE;
+	b -> npending = 0;
+}
+
+/*
+	Returns the length of the Base64 text of "n" bytes.
+*/
+unsigned int EN_Base64EncodedLength (unsigned int n, BOOL pad) {
+	if (pad)
+		return (n + 2) / 3 * 4;
+
+	return n / 3 * 4 + (n % 3 ? n % 3 + 1 : 0);
+}
+
+/*
+	Tells if the last character of a group cut after "k" characters (2 or 3)
+	has any of its unused bits set.
+*/
+static BOOL EN_B64Unused (const struct ENCBASE64* b, unsigned int k) {
+	return (EN_B64Values[b -> alphabet][b -> pending[k - 1]] & (k == 2 ? 0x0F : 0x03)) != 0;
+}
+
+/*
+	Adds character "c" to the pending group of a decoder. Returns FALSE if it
+	can't go there: out of the alphabet, after padding, or padding in the first
+	two places, without "pad" or after unused bits that are set.
+*/
+static BOOL EN_B64Take (struct ENCBASE64* b, BYTE c) {
+	unsigned int k;
+
+	k = b -> npending;
+	if (c == '=') {
+		if (!b -> pad || (k < 2))
+			return FALSE;
+		if ((b -> pending[k - 1] != '=') && EN_B64Unused (b, k))
+			return FALSE;
+	} else if ((EN_B64Values[b -> alphabet][c] == 0xFF) || ((k == 3) && (b -> pending[2] == '=')))
+		return FALSE;
+	b -> pending[b -> npending++] = c;
+
+	return TRUE;
+}
+
+/*
+	Puts the bytes of the pending group of a decoder, checked already, on "out".
+	A short group ends the text.
+*/
+static BOOL EN_B64Flush (struct ENCBASE64* b, struct ENCSTREAM* out) {
+	unsigned int k, i;
+	UCS4 v;
+
+	for (k = 0, v = 0; (k < b -> npending) && (b -> pending[k] != '='); k++)
+		v |= (UCS4) EN_B64Values[b -> alphabet][b -> pending[k]] << (18 - 6 * k);
+	if (!EN_ReserveStream (out, k - 1)) {
+		out -> eob = TRUE;
+		return FALSE;
+	}
+	for (i = 0; i < k - 1; i++)
+		out -> buffer[out -> index++] = (BYTE) (v >> (16 - 8 * i));
+	b -> done = k < 4;
+	b -> npending = 0;
+
+	return TRUE;
+}
+
+/*
+	Encodes the unread part of "in" as Base64 on "out". The bytes of a group
+	cut by the end of the chunk are kept in "b" for the next call or for
+	EN_Base64EncodeFinish().
+
+	[Params]
+
+		b: state, set up with EN_InitBase64().
+		in: binary input. "index" advances over the bytes taken.
+		out: text output. "index" advances over the written characters.
+
+	[Return]
+
+		TRUE if all of "in" was taken, FALSE with "out -> eob" set if output is
+		full. It can be resumed with more room on "out".
+*/
+BOOL EN_Base64Encode (struct ENCBASE64* b, struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	const struct ENKERNELS* kr;
+	unsigned int n, m, r;
+
+	kr = EN_GetKernels ();
+	while ((b -> npending > 0) && (b -> npending < 3) && (in -> index < in -> size))
+		b -> pending[b -> npending++] = in -> buffer[in -> index++];
+	if (b -> npending == 3) {
+		if (!EN_ReserveStream (out, 4)) {
+			out -> eob = TRUE;
+			return FALSE;
+		}
+		out -> index += kr -> b64encode (b -> pending, 3, out -> buffer + out -> index, 4, b -> alphabet) / 3 * 4;
+		b -> npending = 0;
+	}
+	if (b -> npending > 0)
+		return TRUE;
+	n = (in -> size - in -> index) / 3 * 3;
+	m = EN_StreamRoom (out, (unsigned long long) n / 3 * 4);
+	r = kr -> b64encode (in -> buffer + in -> index, n, out -> buffer + out -> index, m, b -> alphabet);
+	in -> index += r;
+	out -> index += r / 3 * 4;
+	if (r < n) {
+		out -> eob = TRUE;
+		return FALSE;
+	}
+	while (in -> index < in -> size)
+		b -> pending[b -> npending++] = in -> buffer[in -> index++];
+
+	return TRUE;
+}
+
+/*
+	Puts the last group of the text, if any, and leaves "b" ready for a new
+	one. Returns FALSE with "out -> eob" set if output is full.
+*/
+BOOL EN_Base64EncodeFinish (struct ENCBASE64* b, struct ENCSTREAM* out) {
+	const char* t;
+	unsigned int k;
+	UCS4 v;
+
+	if (b -> npending > 0) {
+		if (!EN_ReserveStream (out, b -> pad ? 4 : b -> npending + 1)) {
+			out -> eob = TRUE;
+			return FALSE;
+		}
+		t = EN_B64Alphabet[b -> alphabet];
+		v = (UCS4) b -> pending[0] << 16 | (b -> npending > 1 ? (UCS4) b -> pending[1] << 8 : 0);
+		for (k = 0; k <= b -> npending; k++)
+			out -> buffer[out -> index++] = (BYTE) t[v >> (18 - 6 * k) & 0x3F];
+		for (; b -> pad && (k < 4); k++)
+			out -> buffer[out -> index++] = '=';
+	}
+	EN_InitBase64 (b, b -> alphabet, b -> pad);
+
+	return TRUE;
+}
+
+/*
+	Decodes the unread part of Base64 text "in" on "out". The characters of a
+	group cut by the end of the chunk are kept in "b" for the next call or for
+	EN_Base64DecodeFinish().
+
+	[Params]
+
+		b: state, set up with EN_InitBase64().
+		in: text input. "index" advances over the characters taken.
+		out: binary output. "index" advances over the written bytes.
+
+	[Return]
+
+		TRUE if all of "in" was taken. FALSE if output is full ("out -> eob"
+		set, it can be resumed with more room on "out") or on malformed text,
+		with "in -> index" on the character that can't go where it is.
+*/
+BOOL EN_Base64Decode (struct ENCBASE64* b, struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	const struct ENKERNELS* kr;
+	unsigned int n, m, r;
+
+	kr = EN_GetKernels ();
+	for (;;) {
+		if ((b -> npending == 4) && !EN_B64Flush (b, out))
+			return FALSE;
+		if (in -> index == in -> size)
+			return TRUE;
+		if ((b -> npending == 0) && !b -> done) {
+			n = (in -> size - in -> index) / 4 * 4;
+			m = EN_StreamRoom (out, (unsigned long long) n / 4 * 3);
+			r = kr -> b64decode (in -> buffer + in -> index, n, out -> buffer + out -> index, m, b -> alphabet);
+			in -> index += r;
+			out -> index += r / 4 * 3;
+			if (in -> index == in -> size)
+				return TRUE;
+		}
+		// One character at a time up to the end of the group the kernel
+		// stopped on, or of the chunk.
+		if (b -> done || !EN_B64Take (b, in -> buffer[in -> index]))
+			return FALSE;
+		in -> index++;
+	}
+}
+
+/*
+	Ends a text: puts the last group, which may be short only without padding,
+	and leaves "b" ready for a new one.
+
+	[Return]
+
+		FALSE if output is full ("out -> eob" set) or if the text ends in an
+		incomplete group.
+*/
+BOOL EN_Base64DecodeFinish (struct ENCBASE64* b, struct ENCSTREAM* out) {
+	if ((b -> npending == 4) && !EN_B64Flush (b, out))
+		return FALSE;
+	if (b -> npending > 0) {
+		if (b -> pad || (b -> npending < 2) || EN_B64Unused (b, b -> npending))
+			return FALSE;
+		if (!EN_B64Flush (b, out))
+			return FALSE;
+	}
+	EN_InitBase64 (b, b -> alphabet, b -> pad);
+
+	return TRUE;
+}
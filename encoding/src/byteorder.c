@@ -0,0 +1,140 @@
+/*
+	File: byteorder.c
+	Creation: 18-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Buffer level byte order normalization. Takes whole UTF-16 and UCS-4
+		buffers to the machine byte order with the block kernels, instead of
+		swapping one character per call.
+*/
+
+#include <string.h>
+#include "kernels.h"
+
+#define PERM_NONE -1
+// Characters normalized at a time by EN_ReadUCS4Buffer().
+#define UCS4_BLOCK 256
+
+/*
+	Returns the permutation that takes "encoding" to the machine byte order, or
+	PERM_NONE, and its unit size in "unit".
+	The unusual UCS-4 orders are named after a big-endian machine, so on a
+	little-endian one 2143 needs a half swap and 3412 a 2 byte swap.
+*/
+static int EN_NativePerm (enum ENCODING encoding, unsigned int* unit) {
+	*unit = sizeof (UCS4);
+	switch (encoding) {
+#ifdef ARCH_LITTLE_ENDIAN
+		case ENC_UTF16LE:
+			*unit = sizeof (WORD);
+			return PERM_NONE;
+		case ENC_UTF16BE:
+			*unit = sizeof (WORD);
+			return PERM_SWAP16;
+		case ENC_UCS4LE:
+			return PERM_NONE;
+		case ENC_UCS4BE:
+			return PERM_SWAP32;
+		case ENC_UCS4UOO2143:
+			return PERM_SWAPHALVES;
+		case ENC_UCS4UOO3412:
+			return PERM_SWAP16;
+#else
+		case ENC_UTF16LE:
+			*unit = sizeof (WORD);
+			return PERM_SWAP16;
+		case ENC_UTF16BE:
+			*unit = sizeof (WORD);
+			return PERM_NONE;
+		case ENC_UCS4LE:
+			return PERM_SWAP32;
+		case ENC_UCS4BE:
+			return PERM_NONE;
+		case ENC_UCS4UOO2143:
+			return PERM_SWAP16;
+		case ENC_UCS4UOO3412:
+			return PERM_SWAPHALVES;
+#endif
+		default:
+			*unit = sizeof (BYTE);
+			return PERM_NONE;
+	}
+}
+
+/*
+	Puts the whole units of buffer "s" in the machine byte order.
+
+	[Params]
+
+		encoding: encoding of "s". UTF-8, the single byte charsets and ENC_UNKNOWN
+			are copied as they are.
+		s: input buffer.
+		n: input size in bytes.
+		d: output buffer. Can be "s" itself.
+
+	[Return]
+
+		The bytes put on "d". A trailing partial unit is left out.
+*/
+unsigned int EN_ToNativeOrder (enum ENCODING encoding, const BYTE* s, unsigned int n, BYTE* d) {
+	unsigned int i, unit;
+	BYTE t;
+	int p;
+
+	p = EN_NativePerm (encoding, &unit);
+	n -= n % unit;
+	if (p == PERM_NONE) {
+		if (s != d)
+			memmove (d, s, n);
+		return n;
+	}
+	i = EN_GetKernels () -> byteorder (s, n, d, (enum BYTEPERM) p);
+	i += EN_ScalarKernels.byteorder (s + i, n - i, d + i, (enum BYTEPERM) p);
+	// Last UTF-16 unit when the count is odd.
+	if (i < n) {
+		t = s[i];
+		d[i] = s[i + 1];
+		d[i + 1] = t;
+	}
+
+	return n;
+}
+
+/*
+	Reads up to "max" UCS-4 characters from a UCS-4 stream in any of its byte
+	orders into "c", in machine byte order.
+
+	[Return]
+
+		The characters read. As EN_ReadUCS4Le() "s -> index" stops at a character
+		greater than 0x7FFFFFFF, and "s -> eob" is set when the stream ends before
+		"max" characters.
+*/
+unsigned int EN_ReadUCS4Buffer (struct ENCSTREAM* s, enum ENCODING encoding, UCS4* c, unsigned int max) {
+	unsigned int i, j, n, b;
+
+	if ((encoding < ENC_UCS4LE) || (encoding > ENC_UCS4UOO2143))
+		return 0;
+	n = (s -> size - s -> index) / sizeof (UCS4);
+	if (n > max)
+		n = max;
+	// Blocks of UCS4_BLOCK characters, so that an early error doesn't cost a
+	// pass over the whole stream.
+	for (i = 0; i < n; i += b) {
+		b = n - i < UCS4_BLOCK ? n - i : UCS4_BLOCK;
+		EN_ToNativeOrder (encoding, s -> buffer + s -> index + i * sizeof (UCS4), b * sizeof (UCS4), (BYTE*) (c + i));
+		for (j = i; j < i + b; j++)
+			if (c[j] > 0x7FFFFFFF)
+				break;
+		if (j < i + b) {
+			i = j;
+			break;
+		}
+	}
+	s -> index += i * sizeof (UCS4);
+	if ((i == n) && (n < max))
+		s -> eob = TRUE;
+
+	return i;
+}
@@ -0,0 +1,199 @@
+/*
+	File: cpindex.c
+	Creation: 19-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Sparse code point index for random access into UTF-8 text. It keeps the
+		byte offset of every EN_CPINDEX_STRIDE-th character and the character
+		count at every EN_CPINDEX_STRIDE-th byte, so both lookups are one entry
+		plus a count over less than a stride. That's 8 bytes every 512
+		characters (or bytes), about 1.5% of an ASCII text and less for others.
+
+		Characters are counted as bytes that aren't continuation bytes, with the
+		counting kernels. Since that count over a prefix doesn't change when
+		text is appended, the index can be extended as the text grows.
+*/
+
+#include <stdlib.h>
+#include "kernels.h"
+
+// Entries of a new table.
+#define CPI_MIN_ENTRIES 16
+
+/*
+	Appends "v" to table "t" of "n" entries. Capacity is the smallest power of
+	two not below "n" (and CPI_MIN_ENTRIES), so it's only reallocated when
+	"n" gets to one.
+*/
+static BOOL EN_CPIndexAppend (unsigned int** t, unsigned int* n, unsigned int v) {
+	unsigned int* p;
+
+	if ((*n == 0) || ((*n >= CPI_MIN_ENTRIES) && ((*n & (*n - 1)) == 0))) {
+		p = (unsigned int*) realloc (*t, (*n == 0 ? CPI_MIN_ENTRIES : 2 * (unsigned long) *n) * sizeof (unsigned int));
+		if (p == NULL)
+			return FALSE;
+		*t = p;
+	}
+	(*t)[(*n)++] = v;
+
+	return TRUE;
+}
+
+/*
+	Goes forward "k" characters from offset "i" of "s", a lead byte, and returns
+	the offset of the character got to. Counts whole spans at a time: "k - c"
+	characters take at least "k - c" bytes.
+*/
+static unsigned int EN_CPIndexSkip (const BYTE* s, unsigned int n, unsigned int i, unsigned int k) {
+	const struct ENKERNELS* kr;
+	unsigned int c, step;
+
+	kr = EN_GetKernels ();
+	for (c = 0; (c < k) && (i < n); i += step) {
+		step = k - c;
+		if (step > n - i)
+			step = n - i;
+		c += kr -> utf8countchars (s + i, step);
+	}
+	while ((i < n) && ((s[i] & 0xC0) == 0x80))
+		i++;
+
+	return i;
+}
+
+/*
+	Prepares an empty index.
+*/
+void EN_InitCPIndex (struct ENCPINDEX* x) {
+	x -> offsets = x -> chars = NULL;
+	x -> noffsets = x -> nchars = 0;
+	x -> size = x -> length = 0;
+}
+
+/*
+	Frees the tables of an index and leaves it empty.
+*/
+void EN_FreeCPIndex (struct ENCPINDEX* x) {
+	free (x -> offsets);
+	free (x -> chars);
+	EN_InitCPIndex (x);
+}
+
+/*
+	Indexes text appended to the one covered by "x".
+
+	[Params]
+
+		x: index, set up with EN_InitCPIndex().
+		s: the whole text, which may have moved since the last call.
+		n: its length, never less than "x -> size". The first "x -> size" bytes
+			must be the same ones already indexed.
+
+	[Return]
+
+		FALSE if there's no memory for the tables. The index is still usable up
+		to what it covers.
+*/
+BOOL EN_ExtendCPIndex (struct ENCPINDEX* x, const BYTE* s, unsigned int n) {
+	const struct ENKERNELS* kr;
+	unsigned int i, c, k, step;
+
+	kr = EN_GetKernels ();
+	// Characters before every stride of bytes.
+	if ((x -> nchars == 0) && (n > 0) && !EN_CPIndexAppend (&x -> chars, &x -> nchars, 0))
+		return FALSE;
+	while ((x -> nchars > 0) && ((unsigned long) x -> nchars * EN_CPINDEX_STRIDE <= n)) {
+		i = (x -> nchars - 1) * EN_CPINDEX_STRIDE;
+		c = x -> chars[x -> nchars - 1] + kr -> utf8countchars (s + i, EN_CPINDEX_STRIDE);
+		if (!EN_CPIndexAppend (&x -> chars, &x -> nchars, c))
+			return FALSE;
+	}
+	// Offsets of every stride of characters. "c" counts the characters before
+	// "i", and when it gets to the next entry the character starts at the next
+	// lead byte, which may still be missing.
+	i = x -> size;
+	c = x -> length;
+	for (;;) {
+		k = x -> noffsets * EN_CPINDEX_STRIDE;
+		if (c == k) {
+			while ((i < n) && ((s[i] & 0xC0) == 0x80))
+				i++;
+			if (i == n)
+				break;
+			if (!EN_CPIndexAppend (&x -> offsets, &x -> noffsets, i)) {
+				// Up to the entry that couldn't be stored.
+				x -> size = i;
+				x -> length = c;
+				return FALSE;
+			}
+			continue;
+		}
+		if ((step = k - c) > n - i)
+			step = n - i;
+		if (step == 0)
+			break;
+		c += kr -> utf8countchars (s + i, step);
+		i += step;
+	}
+	x -> size = n;
+	x -> length = c;
+
+	return TRUE;
+}
+
+/*
+	Gets the byte offset of a character.
+
+	[Params]
+
+		x: index.
+		s: indexed text.
+		index: character index. "x -> length" stands for the end of the text.
+		offset: byte offset of the character.
+
+	[Return]
+
+		FALSE if "index" is past the end of the indexed text.
+*/
+BOOL EN_CPIndexToOffset (const struct ENCPINDEX* x, const BYTE* s, unsigned int index, unsigned int* offset) {
+	unsigned int k;
+
+	if (index >= x -> length) {
+		*offset = x -> size;
+		return index == x -> length ? TRUE : FALSE;
+	}
+	k = index / EN_CPINDEX_STRIDE;
+	*offset = EN_CPIndexSkip (s, x -> size, x -> offsets[k], index - k * EN_CPINDEX_STRIDE);
+
+	return TRUE;
+}
+
+/*
+	Gets the index of the character a byte belongs to.
+
+	[Params]
+
+		x: index.
+		s: indexed text.
+		offset: byte offset. "x -> size" stands for the end of the text.
+		index: character index, "x -> length" for the end of the text. Bytes
+			before the first lead byte belong to character 0.
+
+	[Return]
+
+		FALSE if "offset" is past the end of the indexed text.
+*/
+BOOL EN_CPIndexFromOffset (const struct ENCPINDEX* x, const BYTE* s, unsigned int offset, unsigned int* index) {
+	unsigned int k, c;
+
+	if (offset >= x -> size) {
+		*index = x -> length;
+		return offset == x -> size ? TRUE : FALSE;
+	}
+	k = offset / EN_CPINDEX_STRIDE;
+	c = x -> chars[k] + EN_GetKernels () -> utf8countchars (s + k * EN_CPINDEX_STRIDE, offset - k * EN_CPINDEX_STRIDE + 1);
+	*index = c > 0 ? c - 1 : 0;
+
+	return TRUE;
+}
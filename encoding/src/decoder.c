@@ -0,0 +1,205 @@
+/*
+	File: decoder.c
+	Creation: 18-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Incremental decoder. Keeps a sequence cut by the end of a buffer so that
+		input can be fed in arbitrary chunks (from a socket, a file, ...) without
+		gathering it in one contiguous buffer first.
+*/
+
+#include <string.h>
+#include "kernels.h"
+
+typedef BOOL (*DECODEFN) (struct ENCSTREAM*, UCS4*);
+
+/*
+	Per character decoder for every encoding, indexed by enum ENCODING.
+*/
+static const DECODEFN DECODERS[] = {
+	NULL,
+	EN_UTF8ToUCS4,
+	EN_UTF16LeToUCS4,
+	EN_UTF16BeToUCS4,
+	EN_ReadUCS4Le,
+	EN_ReadUCS4Be,
+	EN_ReadUCS4Uoo3412,
+	EN_ReadUCS4Uoo2143,
+	EN_ReadLatin1,
+	EN_ReadCP1252,
+	EN_ReadASCII};
+
+/*
+	Prepares a decoder for a new input in encoding "encoding". Malformed input
+	stops it (POL_STRICT) until EN_SetDecoderPolicy() says otherwise.
+*/
+void EN_InitDecoder (struct ENCDECODER* d, enum ENCODING encoding) {
+	d -> encoding = encoding;
+	d -> policy = POL_STRICT;
+	d -> npending = 0;
+}
+
+/*
+	Sets what the decoder does with malformed input. With POL_REPLACE it
+	returns U+FFFD for every maximal subpart of a malformed sequence (for UTF-8
+	as the WHATWG decoder, that is, RFC 3629 and not the 6 byte forms), for
+	every unpaired surrogate and for every UCS-4 value out of range.
+*/
+void EN_SetDecoderPolicy (struct ENCDECODER* d, enum ENPOLICY policy) {
+	d -> policy = policy;
+}
+
+/*
+	Decodes a character from "s" with the policy of "d". With POL_REPLACE it
+	only fails at the end of the buffer.
+*/
+static BOOL EN_Decode (struct ENCDECODER* d, struct ENCSTREAM* s, UCS4* c) {
+	const BYTE* p;
+	unsigned int n;
+	int by;
+
+	if (d -> policy == POL_STRICT)
+		return DECODERS[d -> encoding] (s, c);
+	if (d -> encoding != ENC_UTF8) {
+		if (DECODERS[d -> encoding] (s, c))
+			return TRUE;
+		if (s -> eob)
+			return FALSE;
+		*c = 0xFFFD;
+		s -> index += d -> encoding >= ENC_LATIN1 ? sizeof (BYTE) : d -> encoding <= ENC_UTF16BE ? sizeof (WORD) : sizeof (UCS4);
+		return TRUE;
+	}
+	p = s -> buffer + s -> index;
+	n = s -> size - s -> index;
+	if (n == 0) {
+		s -> eob = TRUE;
+		return FALSE;
+	}
+	if (p[0] < 0x80) {
+		*c = p[0];
+		s -> index++;
+		return TRUE;
+	}
+	if ((by = EN_DecodeUTF8Seq (p, n, c)) < 0) {
+		s -> eob = TRUE;
+		return FALSE;
+	}
+	if (by == 0) {
+		*c = 0xFFFD;
+		by = (int) EN_UTF8Subpart (p, n);
+	}
+	s -> index += by;
+
+	return TRUE;
+}
+
+/*
+	Decodes the next character from "in", continuing a sequence left partial by
+	a previous chunk if there is one.
+
+	[Params]
+
+		d: decoder state.
+		in: current chunk.
+		c: decoded UCS-4 character.
+
+	[Return]
+
+		"TRUE" if a character was decoded. "FALSE" in other case: if "in -> eob" is
+		set the chunk was exhausted and any incomplete sequence at its end was saved
+		in "d", so the caller just feeds the next chunk. Otherwise the input is
+		malformed and "in -> index" points to the erroneous byte (or to the chunk
+		start when the error lies in bytes saved from a previous chunk). The saved
+		bytes are dropped on error. With POL_REPLACE malformed input is decoded
+		as U+FFFD instead, so only the end of the chunk makes it fail.
+*/
+BOOL EN_DecoderRead (struct ENCDECODER* d, struct ENCSTREAM* in, UCS4* c) {
+	BYTE tmp[MAX_UTF8_BYTES];
+	struct ENCSTREAM t;
+	unsigned int k, left;
+
+	if ((d -> encoding == ENC_UNKNOWN) || (d -> encoding > ENC_ASCII))
+		return FALSE;
+	in -> eob = FALSE;
+	left = in -> size - in -> index;
+	if (d -> npending == 0) {
+		if (EN_Decode (d, in, c))
+			return TRUE;
+		// Save the tail of an incomplete sequence. The decoders leave "index" at
+		// the sequence start when they run out of buffer. No sequence is longer
+		// than MAX_UTF8_BYTES, so a longer tail is malformed.
+		if (in -> eob) {
+			left = in -> size - in -> index;
+			if (left > MAX_UTF8_BYTES) {
+				in -> eob = FALSE;
+				return FALSE;
+			}
+			memcpy (d -> pending, in -> buffer + in -> index, left);
+			d -> npending = (BYTE) left;
+			in -> index = in -> size;
+		}
+		return FALSE;
+	}
+	// Join saved bytes with the start of this chunk and decode from a temporary
+	// stream. A sequence is never longer than MAX_UTF8_BYTES.
+	k = MAX_UTF8_BYTES - d -> npending;
+	if (k > left)
+		k = left;
+	memcpy (tmp, d -> pending, d -> npending);
+	memcpy (tmp + d -> npending, in -> buffer + in -> index, k);
+	EN_InitStream (&t, tmp, d -> npending + k);
+	if (EN_Decode (d, &t, c)) {
+		if (t.index < d -> npending) {
+			// A U+FFFD for a part of the saved bytes, the rest are kept.
+			memmove (d -> pending, d -> pending + t.index, d -> npending - t.index);
+			d -> npending -= (BYTE) t.index;
+			return TRUE;
+		}
+		in -> index += t.index - d -> npending;
+		d -> npending = 0;
+		return TRUE;
+	}
+	if (t.eob) {
+		// Still incomplete, the whole chunk belongs to the saved sequence.
+		memcpy (d -> pending + d -> npending, in -> buffer + in -> index, k);
+		d -> npending += (BYTE) k;
+		in -> index += k;
+		in -> eob = TRUE;
+		return FALSE;
+	}
+	if (t.index > d -> npending)
+		in -> index += t.index - d -> npending;
+	d -> npending = 0;
+
+	return FALSE;
+}
+
+/*
+	Decodes up to "max" characters from "in" into "out" and returns how many were
+	decoded. Stops early at the end of the chunk ("in -> eob" set) or on an error
+	(see EN_DecoderRead()).
+*/
+unsigned int EN_DecoderReadBuffer (struct ENCDECODER* d, struct ENCSTREAM* in, UCS4* out, unsigned int max) {
+	unsigned int n;
+
+	for (n = 0; n < max; n++)
+		if (!EN_DecoderRead (d, in, out + n))
+			break;
+
+	return n;
+}
+
+/*
+	Ends the input. Returns "FALSE" if the last chunk ended in the middle of a
+	sequence, which is then discarded. With POL_REPLACE that sequence stands for
+	one more U+FFFD.
+*/
+BOOL EN_DecoderFinish (struct ENCDECODER* d) {
+	BOOL r;
+
+	r = d -> npending == 0 ? TRUE : FALSE;
+	d -> npending = 0;
+
+	return r;
+}
@@ -0,0 +1,168 @@
+/*
+	File: detect.c
+	Creation: 18-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Encoding detection for input without BOM. Decides from the zero bytes at
+		every offset modulo 4 (UTF-16 and UCS-4 text in alphabetic scripts has
+		lots of them in fixed places) and from a UTF-8 validity scan.
+*/
+
+#include <string.h>
+#include "kernels.h"
+
+/*
+	UCS-4 byte orders with the offset modulo 4 of the most significant byte
+	(always zero under 0x01000000), the next one (zero under 0x10000) and the
+	least significant one (rarely zero in text).
+*/
+static const struct {
+	enum ENCODING encoding;
+	BYTE always;
+	BYTE mostly;
+	BYTE low;
+} UCS4ORDERS[4] = {
+	{ENC_UCS4LE, 3, 2, 0},
+	{ENC_UCS4BE, 0, 1, 3},
+	{ENC_UCS4UOO2143, 1, 0, 2},
+	{ENC_UCS4UOO3412, 2, 3, 1}};
+
+/*
+	Scans a UTF-8 sample and returns the malformed sequences found. "multi"
+	returns the continuation bytes of the valid multibyte sequences. A sequence
+	cut by the end of the sample is valid. Stops when there are too many
+	malformed sequences for UTF-8 to be accepted.
+*/
+static unsigned int EN_UTF8Score (const BYTE* s, unsigned int n, unsigned int* multi) {
+	const struct ENKERNELS* k;
+	unsigned int i, v, bad;
+	int by;
+	UCS4 c;
+
+	k = EN_GetKernels ();
+	i = bad = *multi = 0;
+	while (i < n) {
+		v = k -> utf8valid (s + i, n - i);
+		*multi += v - k -> utf8countchars (s + i, v);
+		if ((i += v) == n)
+			break;
+		if ((by = EN_DecodeUTF8Seq (s + i, n - i, &c)) < 0)
+			break;
+		if (++bad * 100 >= n)
+			break;
+		i++;
+	}
+
+	return bad;
+}
+
+/*
+	Counts the distinct byte values at even and odd offsets. UTF-16 text in
+	one script repeats few high bytes.
+*/
+static void EN_DistinctBytes (const BYTE* s, unsigned int n, unsigned int* even, unsigned int* odd) {
+	BYTE seen[2][256];
+	unsigned int i;
+
+	memset (seen, 0, sizeof (seen));
+	for (i = 0; i < n; i++)
+		seen[i & 1][s[i]] = 1;
+	*even = *odd = 0;
+	for (i = 0; i < 256; i++) {
+		*even += seen[0][i];
+		*odd += seen[1][i];
+	}
+}
+
+/*
+	Guesses the encoding of a buffer without BOM. Only the first EN_DETECT_SAMPLE
+	bytes are looked at. A BOM, if present, is trusted.
+
+	[Params]
+
+		s: buffer.
+		n: buffer size in bytes.
+		confidence: if not NULL, returns 0 to 100.
+
+	[Return]
+
+		The encoding or ENC_UNKNOWN.
+*/
+enum ENCODING EN_DetectEncoding (const BYTE* s, unsigned int n, unsigned int* confidence) {
+	struct ENCSTREAM b;
+	enum ENCODING e;
+	unsigned int z[4], q, u, even, odd, bad, multi, c, i;
+
+	e = ENC_UNKNOWN;
+	c = 0;
+	if (n > EN_DETECT_SAMPLE)
+		n = EN_DETECT_SAMPLE;
+	// BOM.
+	EN_InitStream (&b, (BYTE*) s, n);
+	if ((e = EN_SearchEncoding (&b)) != ENC_UNKNOWN) {
+		c = 100;
+		goto done;
+	}
+	q = n / 4;
+	u = n / 2;
+	memset (z, 0, sizeof (z));
+	EN_GetKernels () -> zerocount (s, 4 * q, z);
+	if (q > 0) {
+		// UCS-4: top byte always zero, next one nearly always, low one seldom.
+		for (i = 0; i < 4; i++)
+			if ((z[UCS4ORDERS[i].always] == q) && (z[UCS4ORDERS[i].mostly] * 10 >= q * 9) &&
+					(z[UCS4ORDERS[i].low] * 10 < q)) {
+				e = UCS4ORDERS[i].encoding;
+				c = 60 + 40 * (q - z[UCS4ORDERS[i].low]) / q;
+				goto done;
+			}
+		// UTF-16: zero high bytes on one side only. Outside Latin scripts only
+		// spaces and punctuation have them, so a few are enough.
+		even = z[0] + z[2];
+		odd = z[1] + z[3];
+		if ((odd * 16 >= u) && (even * 10 < odd)) {
+			e = ENC_UTF16LE;
+			c = 50 + 50 * (odd - even) / u;
+			goto done;
+		}
+		if ((even * 16 >= u) && (odd * 10 < even)) {
+			e = ENC_UTF16BE;
+			c = 50 + 50 * (even - odd) / u;
+			goto done;
+		}
+	}
+	// UTF-8: no zero bytes and (nearly) no malformed sequences.
+	if (z[0] + z[1] + z[2] + z[3] == 0) {
+		bad = EN_UTF8Score (s, n, &multi);
+		if (bad == 0) {
+			e = ENC_UTF8;
+			// Pure ASCII is UTF-8 too, but it proves less.
+			c = multi > 0 ? 100 : 90;
+			goto done;
+		}
+		if (bad * 100 < multi) {
+			e = ENC_UTF8;
+			c = 70;
+			goto done;
+		}
+	}
+	// Not UTF-8: UTF-16 in a non alphabetic script (CJK, ...) without spaces.
+	// The side with fewer distinct values holds the high bytes.
+	if ((n % 2 == 0) && (u >= 16)) {
+		EN_DistinctBytes (s, n, &even, &odd);
+		if (odd * 2 < even) {
+			e = ENC_UTF16LE;
+			c = 40;
+		} else if (even * 2 < odd) {
+			e = ENC_UTF16BE;
+			c = 40;
+		}
+	}
+
+done:
+	if (confidence)
+		*confidence = c;
+
+	return e;
+}
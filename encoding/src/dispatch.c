@@ -0,0 +1,111 @@
+/*
+	File: dispatch.c
+	Creation: 18-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Binds the encoding kernels to the best instruction set of the CPU. The
+		detection is done once, on first use. The environment variable EN_ISA
+		("scalar", "sse2", "avx2" or "avx512") selects a lower instruction set,
+		which is useful to test every path on a single host.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "kernels.h"
+
+#define ISA_COUNT 4
+
+static const char* ISANAMES[ISA_COUNT] = {"scalar", "sse2", "avx2", "avx512"};
+
+// Kernel table in use. Written only with pointers to constant tables, so a
+// race between two first calls binds the same table twice and is harmless.
+static const struct ENKERNELS* volatile Kernels = NULL;
+
+/*
+	Returns the kernel table for "isa" or NULL if it wasn't built.
+*/
+static const struct ENKERNELS* EN_KernelTable (enum ENISA isa) {
+	switch (isa) {
+		case ISA_SCALAR:
+			return &EN_ScalarKernels;
+#ifdef EN_X86_KERNELS
+		case ISA_SSE2:
+			return &EN_SSE2Kernels;
+		case ISA_AVX2:
+			return &EN_AVX2Kernels;
+		case ISA_AVX512:
+			return &EN_AVX512Kernels;
+#endif
+		default:
+			return NULL;
+	}
+}
+
+/*
+	Tells if the CPU (and the operating system) supports "isa".
+*/
+static BOOL EN_ISASupported (enum ENISA isa) {
+	if (EN_KernelTable (isa) == NULL)
+		return FALSE;
+#ifdef EN_X86_KERNELS
+	__builtin_cpu_init ();
+	switch (isa) {
+		case ISA_SSE2:
+			return __builtin_cpu_supports ("sse2") ? TRUE : FALSE;
+		case ISA_AVX2:
+			return __builtin_cpu_supports ("avx2") ? TRUE : FALSE;
+		case ISA_AVX512:
+			return __builtin_cpu_supports ("avx512bw") && __builtin_cpu_supports ("popcnt") ? TRUE : FALSE;
+		default:
+			break;
+	}
+#endif
+
+	return isa == ISA_SCALAR ? TRUE : FALSE;
+}
+
+/*
+	Best supported instruction set, limited by EN_ISA if it is set.
+*/
+static enum ENISA EN_DetectISA (void) {
+	const char* env;
+	int isa, limit;
+
+	limit = ISA_COUNT - 1;
+	if ((env = getenv ("EN_ISA")) != NULL)
+		for (isa = 0; isa < ISA_COUNT; isa++)
+			if (strcmp (env, ISANAMES[isa]) == 0)
+				limit = isa;
+	for (isa = limit; isa > ISA_SCALAR; isa--)
+		if (EN_ISASupported ((enum ENISA) isa))
+			break;
+
+	return (enum ENISA) isa;
+}
+
+const struct ENKERNELS* EN_GetKernels (void) {
+	if (Kernels == NULL)
+		Kernels = EN_KernelTable (EN_DetectISA ());
+
+	return Kernels;
+}
+
+/*
+	Returns the instruction set the encoding kernels are bound to.
+*/
+enum ENISA EN_GetISA (void) {
+	return EN_GetKernels () -> isa;
+}
+
+/*
+	Binds the encoding kernels to "isa". Returns "FALSE" if the CPU doesn't
+	support it, and the binding is left as it was.
+*/
+BOOL EN_SetISA (enum ENISA isa) {
+	if (!EN_ISASupported (isa))
+		return FALSE;
+	Kernels = EN_KernelTable (isa);
+
+	return TRUE;
+}
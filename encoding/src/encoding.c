@@ -15,36 +15,52 @@
 			http://www.faqs.org/rfcs/rfc2781.html
 */
 
-#include "encoding.h"
-
-// For use in functions en_read_ucs4_le(), en_read_ucs4_be(), en_read_ucs4_uoo2143() and
-// en_read_ucs4_uoo3412().
-// TY_NONE: no swap must be done on UCS-4 character bytes.
-// TY_NORMAL: normal swap on UCS-4 character bytes (1234 -> 4321).
-// TY_UOO2143: abnormal swap must be done. (2143 -> 1234).
-// TY_UOO3412: Idem to TY_UOO2143.
-enum UCS4_TYPES {TY_NONE, TY_NORMAL, TY_UOO2143, TY_UOO3412};
-
-/*
-	Swap the word's bytes.
-*/
-WORD EN_SwapBytesW (WORD w) {
-	return ((w & 0x00FF) << 8 | (w & 0xFF00) >> 8);
-}
-
-UCS4 EN_SwapUCS4Bytes (UCS4 c) {	
-	return ((c & 0x000000FF) << 24 | (c & 0xFF000000) >> 24 |
-					(c & 0x0000FF00) << 8 | (c & 0x00FF0000) >> 8);
-}
-
-UCS4 ENSwapUCS4Uoo2143 (UCS4 c) {
-	return ((c & 0xFF000000) >> 8 || (c & 0x00FF0000) << 8 ||
-					(c & 0x0000FF00) >> 8 || (c & 0x000000FF) << 8);
-}
-
-UCS4 EN_SwapUCS4Uoo3412 (UCS4 c) {
-	return ((c & 0xFFFF0000) >> 16 || (c & 0x0000FFFF) << 16);
-}
+#include <stdlib.h>
+#include <string.h>
+#include "enccodec.h"
+
+// UTF-8 decoding automaton states. States above ST_REJECT are waiting for
+// continuation bytes.
+// ST_NEED1-ST_NEED5: 1 to 5 continuation bytes (10xxxxxx) left.
+// ST_E0, ST_F0, ST_F8, ST_FC: first continuation byte after these leads is
+// restricted to reject overlong forms.
+enum UTF8_STATES {ST_ACCEPT, ST_REJECT, ST_NEED1, ST_NEED2, ST_NEED3, ST_NEED4, ST_NEED5,
+		ST_E0, ST_F0, ST_F8, ST_FC};
+
+// Byte classes for the automaton.
+// 0: 00-7F, 1: 80-83, 2: 84-87, 3: 88-8F, 4: 90-9F, 5: A0-BF, 6: C0-C1 (overlong),
+// 7: C2-DF, 8: E0, 9: E1-EF, 10: F0, 11: F1-F7, 12: F8, 13: F9-FB, 14: FC, 15: FD,
+// 16: FE-FF.
+static const BYTE UTF8CLASS[256] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+	5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+	6, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+	8, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 10, 11, 11, 11, 11, 11, 11, 11, 12, 13, 13, 13, 14, 15, 16, 16};
+
+// Payload bits of a lead byte by class.
+static const BYTE UTF8MASK[17] = {
+	0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x0F, 0x0F, 0x07, 0x07, 0x03, 0x03, 0x01, 0x01, 0x00};
+
+// Transitions indexed by [state][class].
+static const BYTE UTF8TRANS[11][17] = {
+	{0, 1, 1, 1, 1, 1, 1, 2, 7, 3, 8, 4, 9, 5, 10, 6, 1},
+	{1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+	{1, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+	{1, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+	{1, 3, 3, 3, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+	{1, 4, 4, 4, 4, 4, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+	{1, 5, 5, 5, 5, 5, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+	{1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+	{1, 1, 1, 1, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+	{1, 1, 1, 4, 4, 4, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+	{1, 1, 5, 5, 5, 5, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}};
+
+// UTF-8 lead byte marker by sequence length.
+static const BYTE UTF8LEAD[7] = {0x00, 0x00, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC};
 
 void EN_ClearUTF8 (UTF8 u) {
 	BYTE i;
@@ -57,110 +73,132 @@ void EN_ClearUCS4 (UCS4* c) {
 	*c = 0;
 }
 
-BOOL EN_ReadUCS4 (struct ENCSTREAM* s, enum UCS4_TYPES swaptype, UCS4* c) {
-	// Check buffer end.
-	if (s -> size - s -> index < sizeof (UCS4)) {
-		s -> eob = TRUE;
-		return FALSE;
+/*
+	Allocates a stream with a fixed buffer of "buffersize" bytes.
+
+	[Return]
+
+		The stream or NULL if there is no memory.
+*/
+struct ENCSTREAM* EN_NewStream (unsigned int buffersize) {
+	struct ENCSTREAM* s;
+	
+	if ((s = (struct ENCSTREAM*) malloc (sizeof (struct ENCSTREAM))) == NULL)
+		return NULL;
+	if ((s -> buffer = (BYTE*) malloc (buffersize)) == NULL) {
+		free (s);
+		return NULL;
 	}
-	// Copy UCS-4 character from buffer.
-	memcpy (c, s -> buffer, sizeof (UCS4));
-	// No character grater than 0x7FFFFFFF are permited.	
-	if (*c > 0x7FFFFFFF)
-		return FALSE;
-	// Swap if necessary.
-	switch (swaptype) {
-		case TY_NORMAL:
-			*c = EN_SwapUCS4Bytes (*c);
-			break;
-		case TY_UOO2143:
-			*c = EN_SwapUCS4Uoo2143 (*c);
-			break;
-		case TY_UOO3412:
-			*c = EN_SwapUCS4Uoo3412 (*c);
-	};
+	EN_InitStream (s, s -> buffer, buffersize);
 
-	return TRUE;
+	return s;
 }
 
-BOOL EN_UTF16ToUCS4 (struct ENCSTREAM* b, BOOL swap, UCS4* c) {
-	WORD w1, w2;
+/*
+	Allocates an output stream that grows as it is written, so that encoding
+	into it only fails for lack of memory. The buffer doubles every time it gets
+	full, that is, a stream of n bytes takes O(log n) allocations.
+
+	[Params]
 
-	// Check buffer limit.
-	if (b -> size - b -> index < sizeof (WORD)) {
-		b -> eob = TRUE;
-		return FALSE;
-	}
-	// Clear UCS-4 character to return.
-	EN_ClearUCS4 (c);
-	// Copy a word from UTF-16 stream.
-	memcpy (&w1, b -> buffer + b -> index, sizeof (WORD));
-	// Swap bytes ?
-	if (swap)
-		EN_SwapBytesW (w1);
-	// Check word value. If "w1" is less than 0xD800 or grater than 0xDFFF.
-	// Done, UCS-4 character is "w1".
-	if ((w1 < 0xD800) || (w1 > 0xDFFF)) {
-		*c = (UCS4) w1;
-		// Update pointer to UTF-16 stream.
-		b -> index += sizeof (WORD);
-		return TRUE;
-	}
-	// Check if "w1" is between 0xD800 and 0xDBFF. If not, the sequence is in
-	// error.
-	if ((w1 < 0xD800) || (w1 > 0xDBFF))
-		return FALSE;
-	// Check buffer limit again.
-	if (b -> size - b -> index < 2 * sizeof (WORD)) {
-		b -> eob = TRUE;
-		return FALSE;
-	}
-	// Copy another word.
-	memcpy (&w2, b -> buffer + b -> index + sizeof (WORD), sizeof (WORD));
-	// Check byte swaping.
-	if (swap)
-		EN_SwapBytesW (w2);
-	// Check if "w2" is between 0xDC00 and 0xDFFF. If not, the sequence is in
-	// error.
-	if ((w2 < 0xDC00) || (w2 > 0xDFFF)) 
-		return FALSE;
-	// Construct a 20-bit unsigned integer with 10 low-order bits of "w1" as the
-	// 10 high-order bits of it, and 10 low-order bits of "w2" as the 10 low-order
-	// bits of it.
-	*c = (UCS4) (w1 & 0x03FF) << 10 | (UCS4) (w2 & 0x03FF);
-	*c += 0x00010000;
-	// Adjust stream index.
-	b -> index += 2 * sizeof (WORD);
+		buffersize: initial capacity, may be 0.
+		allocator: memory functions for the stream and its buffer, or NULL for
+			realloc() and free().
 
-	return TRUE;
-}
+	[Return]
 
-struct ENCSTREAM* EN_NewStream (unsigned int buffersize) {
+		The stream or NULL if there is no memory.
+*/
+struct ENCSTREAM* EN_NewGrowingStream (unsigned int buffersize, const struct ENCALLOCATOR* allocator) {
 	struct ENCSTREAM* s;
-	
-	if ((s = (struct ENCSTREAM*) malloc (sizeof (struct ENCSTREAM))) == NULL)
-		return NULL;
-	
-	if ((s -> buffer = (BYTE*) malloc (buffersize)) == NULL)
-		goto fail;
 
-	s -> index = 0;
-	s -> size = 0;
-	s -> eob = FALSE;
-	
-fail:
-	free (s);
+	if (allocator)
+		s = (struct ENCSTREAM*) allocator -> realloc (allocator -> ctx, NULL, sizeof (struct ENCSTREAM));
+	else
+		s = (struct ENCSTREAM*) malloc (sizeof (struct ENCSTREAM));
+	if (s == NULL)
+		return NULL;
+	EN_InitStream (s, NULL, 0);
+	s -> grow = TRUE;
+	s -> allocator = allocator;
+	if ((buffersize > 0) && !EN_ReserveStream (s, buffersize)) {
+		if (allocator)
+			allocator -> free (allocator -> ctx, s);
+		else
+			free (s);
+		return NULL;
+	}
 
-	return NULL;
+	return s;
 }
 
+/*
+	Frees a stream from EN_NewStream() or EN_NewGrowingStream() and its buffer.
+*/
 void EN_FreeStream (struct ENCSTREAM* s) {
+	if (s -> allocator) {
+		s -> allocator -> free (s -> allocator -> ctx, s -> buffer);
+		s -> allocator -> free (s -> allocator -> ctx, s);
+		return;
+	}
 	free (s -> buffer);
 	free (s);
 
 	return;
 }
 
+/*
+	Sets up a stream over a fixed buffer of "size" bytes (data length if it is
+	read, capacity if it is written).
+*/
+void EN_InitStream (struct ENCSTREAM* s, BYTE* buffer, unsigned int size) {
+	s -> buffer = buffer;
+	s -> index = 0;
+	s -> size = size;
+	s -> eob = FALSE;
+	s -> grow = FALSE;
+	s -> allocator = NULL;
+}
+
+/*
+	Makes room for "n" more bytes after "s -> index". Growing streams at least
+	double their capacity, fixed ones just tell if there is room.
+
+	[Return]
+
+		"TRUE" if there are "n" free bytes, "FALSE" if the stream is fixed and
+		there aren't, or if there is no memory. The stream is left as it was then.
+*/
+BOOL EN_ReserveStream (struct ENCSTREAM* s, unsigned int n) {
+	unsigned long need, size;
+	BYTE* p;
+
+	if (s -> size - s -> index >= n)
+		return TRUE;
+	if (!s -> grow)
+		return FALSE;
+	need = (unsigned long) s -> index + n;
+	if (need > 0xFFFFFFFFUL)
+		return FALSE;
+	size = 2 * (unsigned long) s -> size;
+	if (size < need)
+		size = need;
+	if (size < 64)
+		size = 64;
+	if (size > 0xFFFFFFFFUL)
+		size = 0xFFFFFFFFUL;
+	if (s -> allocator)
+		p = (BYTE*) s -> allocator -> realloc (s -> allocator -> ctx, s -> buffer, size);
+	else
+		p = (BYTE*) realloc (s -> buffer, size);
+	if (p == NULL)
+		return FALSE;
+	s -> buffer = p;
+	s -> size = (unsigned int) size;
+
+	return TRUE;
+}
+
 /*
 	Search for special bytes that tell how was the stream's encoding.
 	
@@ -258,76 +296,43 @@ enum ENCODING EN_SearchEncoding (struct ENCSTREAM* b) {
 	
 		"TRUE" if no error was founded, "FALSE" in other case.
 */
-BOOL EN_UCS4ToUFT8 (UCS4 c, struct ENCSTREAM* b) {
-	BYTE i, p, by;
-	UCS4 m;
-	UTF8 u;
+BOOL EN_UCS4ToUTF8 (UCS4 c, struct ENCSTREAM* b) {
+	BYTE* d;
+	BYTE by;
+	BYTE k;
 
-	// Init UTF-8 encoding with zeros.
-	EN_ClearUTF8 (u);
 	// UCS-4 character must not be greater than 7FFF FFFF.
 	if (c > 0x7FFFFFFF)
 		return FALSE;
-	// Calculate how many bytes will ocupy UTF-8 encoding.
-	if (c >= 0x04000000)
-		// UCS-4 character in [0400 0000-7FFF FFFF] range.
-		by = 6;
-	else if (c >= 0x00200000)
-		// UCS-4 character in [0020 0000-03FF FFFF] range.
-		by = 5;
-	else if (c >= 0x00010000)
-		// UCS-4 character in [0001 0000-001F FFFF] range.
-		by = 4;
-	else if (c >= 0x00000800)
-		// UCS-4 character in [0000 0800-0000 FFFF] range.
-		by = 3;
-	else if (c >= 0x00000080)
-		// UCS-4 character in [0000 0080-0000 07FF] range.
-		by = 2;
-	else
-		// UCS-4 character in [0000 0000-0000 007F] range.
-		by = 1;
+	// Calculate how many bytes will ocupy UTF-8 encoding. Every comparison adds
+	// one byte, so there is no branch per range:
+	// [0000 0000-0000 007F] 1 byte	- [0020 0000-03FF FFFF] 5 bytes
+	// [0000 0080-0000 07FF] 2 bytes	- [0400 0000-7FFF FFFF] 6 bytes
+	// [0000 0800-0000 FFFF] 3 bytes
+	// [0001 0000-001F FFFF] 4 bytes
+	by = 1 + (c >= 0x00000080) + (c >= 0x00000800) + (c >= 0x00010000) +
+			(c >= 0x00200000) + (c >= 0x04000000);
 	// Check space on buffer for needed bytes.
-	if (b -> size - b -> index < by) {
+	if ((b -> size - b -> index < by) && !EN_ReserveStream (b, by)) {
 		b -> eob = TRUE;
 		return FALSE;
 	}
-	// Check byte count for UTF-8 encoding.
-	if (by == 1)
-		// UCS-4 character is simply an ASCII-7 character. Just copy it.
-		u[0] = (BYTE) (c & 0x000000FF);
-	else {
-		// UCS-4 character ocupy 2 or more bytes in UTF-8 encoding.
-		// Initialize b-1 bytes with 10xxxxxx binary pattern.
-		for (i = by-1; i > 0; i--)
-			u[i] = 0x80;
-		// Most significant byte must be:
-		// 11000000 (b = 2) - 11111000 (b = 5)
-		// 11100000 (b = 3) - 11111100 (b = 6)
-		// 11110000 (b = 4)
-		u[0] = (2 << by)-1 << 8-by;
-		// Fill in the bits in UTF-8 encoding.
-		for (i = by-1, p = 1, m = 1;; p=p%6+1, m<<=1)
-		{
-			// When reach the last byte and the previous bit was the last, exit loop.
-			if ((i == 0) && (p == 8-by))
-				break;
-			// "m" indicates what bit to process in UCS-4 character.
-			// "p" indicates what bit must be set on UTF-8 encoding.
-			u[i] = u[i] & ~p | (c & m ? p : 0x00);
-			if (p == 6)
-				i--;
-		}
+	d = b -> buffer + b -> index;
+	// Fill trailing bytes (10xxxxxx) from the last one, six bits each, and the
+	// remaining bits go into the lead byte.
+	for (k = by - 1; k > 0; k--) {
+		d[k] = (BYTE) (0x80 | (c & 0x3F));
+		c >>= 6;
 	}
-	// Last, copy UTF-8 bytes to stream.
-	memcpy (b -> buffer, u + MAX_UTF8_BYTES-by, by);
+	d[0] = (BYTE) (UTF8LEAD[by] | c);
 	b -> index += by;
 
 	return TRUE;
 }
 
 /*
-	Encodes an UCS-4 character to UTF-16 encoding.
+	Encodes an UCS-4 character to UTF-16 encoding, big endian as the decoders
+	read it.
 	
 	[Params]
 		
@@ -340,48 +345,7 @@ BOOL EN_UCS4ToUFT8 (UCS4 c, struct ENCSTREAM* b) {
 		"TRUE" if no error was founded, "FALSE" in other case.
 */
 BOOL EN_UCS4ToUTF16 (UCS4 c, struct ENCSTREAM* b) {
-	UCS4 u;
-	WORD w1, w2;
-
-	// UCS-4 characters greater than 0x0010FFFF can not be encoded.
-	if (c > 0x0010FFFF)
-		return FALSE;
-	// UCS-4 values between 0xD800 and 0xDFFF are invalid.
-	if ((c >= 0x0000D800) && (c <= 0x0000DFFF))
-		return FALSE;
-	// Check if UCS-4 character is less than 0x00010000.
-	if (c < 0x00010000) {
-		// Check buffer limit.
-		if (b -> size - b -> index < sizeof (WORD)) {
-			b -> eob = TRUE;
-			return FALSE;
-		}
-		*(b -> buffer + b -> index) = (BYTE) ((c & 0x0000FF00) >> 8);
-		*(b -> buffer + b -> index+1) = (BYTE) (c & 0x000000FF);
-		b -> index += sizeof (WORD);
-		return TRUE;
-	}
-	// Check buffer limit again.
-	if (b -> size - b -> index < sizeof (UTF16)) {
-		b -> eob = TRUE;
-		return FALSE;
-	}
-	// Create a new UCS-4 character substracting 0x00010000 from UCS-4 character
-	// passed as parameter. New character must be between 0x00000000 and 0x000FFFFF
-	// and can be represented with 20 bits.
-	EN_ClearUCS4 (&u);
-	u = c - 0x00010000;
-	// Initialize to unsigned words with 0xD800 and 0xDC00 respectively.
-	w1 = 0xD800;
-	w2 = 0xDC00;
-	w1 = w1 & 0xFC00 | (WORD) ((u & 0x000FFC00) >> 10);
-	w2 = w2 & 0xFC00 | (WORD) (u & 0x000003FF);
-	// Copy WORDs to UTF-16 stream.
-	memcpy (b -> buffer + b -> index, &w1, sizeof (WORD));
-	memcpy (b -> buffer + b -> index + sizeof (WORD), &w2, sizeof (WORD));
-	b -> index += sizeof (UTF16);
-
-	return TRUE;
+	return EN_EncodeUTF16 (c, b, TRUE);
 }
 
 /*
@@ -400,60 +364,43 @@ BOOL EN_UCS4ToUTF16 (UCS4 c, struct ENCSTREAM* b) {
 		If an error occurs index will point to the erroneous byte.
 */
 BOOL EN_UTF8ToUCS4 (struct ENCSTREAM* b, UCS4* c) {
-	BYTE by, i, p;
-	UCS4 m;
+	const BYTE* p;
+	unsigned int i, n;
+	BYTE st, cl;
 
 	// Check buffer limit.
 	if (b -> size - b -> index < sizeof (BYTE)) {
 		b -> eob = TRUE;
 		return FALSE;
 	}
-	// Clear UCS-4 character.
-	EN_ClearUCS4 (c);
-	// Test invalid encoding.
-	if (((*(b -> buffer + b -> index) >= 0x80) && (*(b -> buffer + b -> index) <= 0xC0)) ||
-			(*(b -> buffer + b -> index) == 0xFE) || (*(b -> buffer + b -> index) == 0xFF))
-		return FALSE;
-	// Determine UTF-8 encoding length based on first byte. 		
+	p = b -> buffer + b -> index;
 	// Special case: 1 byte (0xxxxxxx) UTF-8 encoding coincides with 7-bit ASCII.
-	if (*(b -> buffer + b -> index) & 0x80 == 0) {
-		// Just copy the byte.
-		*c = ((UCS4) *(b -> buffer + b -> index)) & 0x000000FF;
-		// Increment stream pointer one position.
+	if (p[0] < 0x80) {
+		*c = (UCS4) p[0];
 		b -> index++;
 		return TRUE;
-	} else {
-		// 10xxxxxx, 11111110 and 11111111 is invalid UTF-8 encoding byte and was tested before.
-		// 110xxxxx -> 2 bytes UTF-8 encoding.
-		// 1110xxxx -> 3 bytes UTF-8 encoding.
-		// 11110xxx -> 4 bytes UTF-8 encoding.
-		// 111110xx -> 5 bytes UTF-8 encoding.
-		// 1111110x -> 6 bytes UTF-8 encoding.
-		for (m = 0x20, i = 1;; m>>=1, i++)
-			if (*(b -> buffer + b -> index) & m == 0)
-				break;
-	}	
-	by = i+1;
-	// Check buffer limit again.
-	if (b -> size - b -> index < by) {
-		b -> eob = TRUE;
-		return FALSE;
 	}
-	// Process all UTF-8 encoding bits and put every one on UCS4 character.
-	for (m = 1, p = 1;; p=p%6+1, p=p%6+1, m<<=1) {
-		if ((i == 0) && (p == 8-by))
-			break;
-		// Check that the two most significant bits are 1 and 0 (10xxxxxx).
-		if (*(b -> buffer + b -> index + i) & 0xC0 != 0x80) {
-			// Adjust index so it points to failed byte.
-			b -> index += i;
+	// Run the automaton. The lead byte contributes the bits under its class mask
+	// and every continuation byte six more bits.
+	n = b -> size - b -> index;
+	cl = UTF8CLASS[p[0]];
+	st = UTF8TRANS[ST_ACCEPT][cl];
+	*c = (UCS4) (p[0] & UTF8MASK[cl]);
+	for (i = 1; st > ST_REJECT; i++) {
+		// Sequence doesn't fit in buffer.
+		if (i >= n) {
+			b -> eob = TRUE;
 			return FALSE;
 		}
-		*c = *c & ~m | (*(b -> buffer + b -> index + i) & p ? m : 0x00000000);
-		if (p == 6)
-			i--;
+		st = UTF8TRANS[st][UTF8CLASS[p[i]]];
+		*c = *c << 6 | (p[i] & 0x3F);
 	}
-	b -> index += by;
+	if (st == ST_REJECT) {
+		// Adjust index so it points to failed byte.
+		b -> index += i - 1;
+		return FALSE;
+	}
+	b -> index += i;
 
 	return TRUE;
 }
@@ -472,48 +419,31 @@ BOOL EN_UTF8ToUCS4 (struct ENCSTREAM* b, UCS4* c) {
 		"TRUE" if no error found, "FALSE" in other case.
 */
 BOOL EN_UTF16LeToUCS4 (struct ENCSTREAM* b, UCS4* c) {
-#ifdef ARCH_BIG_ENDIAN
-	return EN_UTF16ToUCS4 (b, TRUE, c);
-#else
-	return EN_UTF16ToUCS4 (b, FALSE, c);
-#endif
+	return EN_DecodeUTF16 (b, c, FALSE);
 }
 
 /*
 	Idem to en_utf16le_to_ucs4().
 */
 BOOL EN_UTF16BeToUCS4 (struct ENCSTREAM* b, UCS4* c) {
-#ifdef ARCH_LITTLE_ENDIAN
-	return EN_UTF16ToUCS4 (b, TRUE, c);
-#else
-	return EN_UTF16ToUCS4 (b, FALSE, c);
-#endif
+	return EN_DecodeUTF16 (b, c, TRUE);
 }
 
 /*
-	Read an UCS-4 character from stream. Swap bytes if necessary according with
-	architecture (big or little endian).
+	Read an UCS-4 character from stream, in the byte order of its name.
 */
 BOOL EN_ReadUCS4Le (struct ENCSTREAM* s, UCS4* c) {
-#ifdef ARCH_BIG_ENDIAN
-	return EN_ReadUCS4 (s, TY_NORMAL, c);
-#else
-	return EN_ReadUCS4 (s, TY_NONE, c);
-#endif
+	return EN_DecodeUCS4 (s, c, ENC_UCS4LE);
 }
 
 BOOL EN_ReadUCS4Be (struct ENCSTREAM* s, UCS4* c) {
-#ifdef ARCH_LITTLE_ENDIAN
-	return EN_ReadUCS4 (s, TY_NORMAL, c);
-#else
-	return EN_ReadUCS4 (s, TY_NONE, c);
-#endif
+	return EN_DecodeUCS4 (s, c, ENC_UCS4BE);
 }
 
 BOOL EN_ReadUCS4Uoo3412 (struct ENCSTREAM* s, UCS4* c) {
-	return EN_ReadUCS4 (s, TY_UOO3412, c);
+	return EN_DecodeUCS4 (s, c, ENC_UCS4UOO3412);
 }
 
 BOOL EN_ReadUCS4Uoo2143 (struct ENCSTREAM* s, UCS4* c) {
-	return EN_ReadUCS4 (s, TY_UOO2143, c);
+	return EN_DecodeUCS4 (s, c, ENC_UCS4UOO2143);
 }
@@ -0,0 +1,268 @@
+/*
+	File: find.c
+	Creation: 19-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Substring search on UTF-8 text, right on its bytes, with no decoding
+		to UCS-4. A kernel skips the blocks with no candidate, where two bytes
+		of the needle aren't at their distance: the last bytes of its first
+		and last characters for an exact search, and ignoring case, the last
+		bytes of any variant of two characters with only length stable ones
+		between them. Candidates are then checked one at a time, the text
+		before the first anchor matched backwards.
+
+		A valid needle starts with a lead byte and ends with a whole
+		character, so a match always starts and ends on character boundaries
+		of the text, malformed sequences taken byte by byte.
+*/
+
+#include <string.h>
+#include "kernels.h"
+
+/*
+	Exact search of "m" bytes "needle", from 1 to "n", on "s". The filter
+	takes the last byte of the first character, as lead bytes repeat a lot
+	on most scripts. Returns the offset of the first match, or "n" if there
+	is none.
+*/
+static unsigned int EN_FindExact (const struct ENKERNELS* kr, const BYTE* s, unsigned int n, const BYTE* needle,
+			unsigned int m) {
+	unsigned int i, k, limit;
+	BYTE a, b;
+
+	for (k = 1; (k < m) && ((needle[k] & 0xC0) == 0x80); k++)
+		;
+	a = needle[k - 1];
+	b = needle[m - 1];
+	// Offsets where the needle fits.
+	limit = n - m + 1;
+	for (i = 0; i < limit; i++) {
+		i += kr -> findpair (s + i + k - 1, n - i - k + 1, a, b, m - k);
+		while ((i < limit) && ((s[i + k - 1] != a) || (s[i + m - 1] != b)))
+			i++;
+		if ((i < limit) && (memcmp (s + i, needle, m) == 0))
+			return i;
+	}
+
+	return n;
+}
+
+/*
+	Tells if the folded text of "s" from "*i" starts with the folded "m" bytes
+	"needle", and moves "*i" past it if it does.
+*/
+static BOOL EN_FoldMatch (const BYTE* s, unsigned int n, unsigned int* i, const BYTE* needle, unsigned int m) {
+	unsigned int j, k;
+
+	for (j = *i, k = 0; k < m; )
+		if ((j == n) || (EN_FoldNext (s, n, &j) != EN_FoldNext (needle, m, &k)))
+			return FALSE;
+	*i = j;
+
+	return TRUE;
+}
+
+/*
+	Puts "c" on "d" as UTF-8 and returns its length.
+*/
+static inline unsigned int EN_FindPutUTF8 (BYTE* d, UCS4 c) {
+	if (c < 0x80) {
+		d[0] = (BYTE) c;
+		return 1;
+	}
+	if (c < 0x800) {
+		d[0] = (BYTE) (0xC0 | c >> 6);
+		d[1] = (BYTE) (0x80 | (c & 0x3F));
+		return 2;
+	}
+	if (c < 0x10000) {
+		d[0] = (BYTE) (0xE0 | c >> 12);
+		d[1] = (BYTE) (0x80 | (c >> 6 & 0x3F));
+		d[2] = (BYTE) (0x80 | (c & 0x3F));
+		return 3;
+	}
+	d[0] = (BYTE) (0xF0 | c >> 18);
+	d[1] = (BYTE) (0x80 | (c >> 12 & 0x3F));
+	d[2] = (BYTE) (0x80 | (c >> 6 & 0x3F));
+	d[3] = (BYTE) (0x80 | (c & 0x3F));
+
+	return 4;
+}
+
+/*
+	Last bytes of the characters that fold to the same as needle character
+	"c", on "set" (4, repeated as needed), and the shortest and longest of
+	them on "*shortest" and "*longest".
+*/
+static void EN_FoldSet (UCS4 c, BYTE* set, unsigned int* shortest, unsigned int* longest) {
+	BYTE d[FOLD_VARIANTS][4];
+	unsigned int k, nv, len[FOLD_VARIANTS];
+	UCS4 v[FOLD_VARIANTS];
+
+	nv = EN_CaseVariants (c, v);
+	*shortest = 4;
+	*longest = 0;
+	for (k = 0; k < nv; k++) {
+		len[k] = EN_FindPutUTF8 (d[k], v[k]);
+		*shortest = len[k] < *shortest ? len[k] : *shortest;
+		*longest = len[k] > *longest ? len[k] : *longest;
+	}
+	for (k = 0; k < 4; k++)
+		set[k] = d[k % nv][len[k % nv] - 1];
+}
+
+/*
+	Tells if the folded text of "s" ending at "i" ends with the folded "m"
+	bytes "needle", and puts where it starts on "*start" if it does. A
+	character is taken back to its lead byte and must end right at the
+	point, so malformed bytes never match.
+*/
+static BOOL EN_FoldMatchBack (const BYTE* s, unsigned int i, unsigned int* start, const BYTE* needle,
+			unsigned int m) {
+	unsigned int j, k, b, e, x, y;
+
+	for (j = i, k = m; k > 0; j = b, k = e) {
+		if (j == 0)
+			return FALSE;
+		for (b = j - 1; (b > 0) && (j - b < 4) && ((s[b] & 0xC0) == 0x80); b--)
+			;
+		for (e = k - 1; (needle[e] & 0xC0) == 0x80; e--)
+			;
+		x = b;
+		y = e;
+		if ((EN_FoldNext (s, j, &x) != EN_FoldNext (needle, m, &y)) || (x != j))
+			return FALSE;
+	}
+	*start = j;
+
+	return TRUE;
+}
+
+/*
+	Search of "needle" ignoring case. A match ends its first "split" bytes
+	with a byte of "a" at some "p", which takes from "shortest" to "longest"
+	bytes of the text, and has a byte of "b" at "p" + "gap". Returns the
+	offset of the first match, or "n" if there is none, and its end on
+	"*end".
+*/
+static unsigned int EN_FindFolded (const struct ENKERNELS* kr, const BYTE* s, unsigned int n, const BYTE* needle,
+			unsigned int m, unsigned int split, const BYTE* a, const BYTE* b, unsigned int gap,
+			unsigned int shortest, unsigned int longest, unsigned int* end) {
+	unsigned int p, j, limit, start, first;
+
+	if (n < gap + shortest)
+		return n;
+	limit = n - gap;
+	// With prefixes of varying length a later candidate may start before,
+	// up to "longest" - "shortest" bytes.
+	for (p = shortest - 1, first = n; p < limit; p++) {
+		p += kr -> findsets (s + p, n - p, a, b, gap);
+		while ((p < limit) && (((s[p] != a[0]) && (s[p] != a[1]) && (s[p] != a[2]) && (s[p] != a[3])) ||
+				((s[p + gap] != b[0]) && (s[p + gap] != b[1]) && (s[p + gap] != b[2]) && (s[p + gap] != b[3]))))
+			p++;
+		if ((p == limit) || ((first < n) && (p + 1 >= first + longest)))
+			break;
+		j = p + 1;
+		if (EN_FoldMatchBack (s, p + 1, &start, needle, split) && (start < first) &&
+				EN_FoldMatch (s, n, &j, needle + split, m - split)) {
+			first = start;
+			*end = j;
+		}
+	}
+
+	return first;
+}
+
+/*
+	Decodes the character at "*i" of valid UTF-8 "s" and moves "*i" past it.
+*/
+static inline UCS4 EN_FindNext (const BYTE* s, unsigned int n, unsigned int* i) {
+	UCS4 c;
+
+	c = s[*i];
+	if (c < 0x80)
+		(*i)++;
+	else
+		*i += EN_DecodeUTF8Seq (s + *i, n - *i, &c);
+
+	return c;
+}
+
+/*
+	Finds UTF-8 text "needle" on UTF-8 text "s", with no decoding. The match
+	starts and ends on character boundaries of "s".
+
+	[Params]
+
+		s, n: text and its length.
+		needle, m: text to find and its length. It must be valid UTF-8.
+		fold: ignore case, comparing the simple case foldings of the characters
+			as EN_CaseFoldCompare() does. The match may then have a length
+			other than "m".
+		at: offset of the first match.
+		length: bytes of the match.
+
+	[Return]
+
+		"TRUE" if "needle" is on "s", "FALSE" if it isn't or is malformed. An
+		empty needle is found at 0.
+*/
+BOOL EN_Find (const BYTE* s, unsigned int n, const BYTE* needle, unsigned int m, BOOL fold, unsigned int* at,
+			unsigned int* length) {
+	const struct ENKERNELS* kr;
+	unsigned int i, j, k, lo, hi, split, shortest, longest, end;
+	UCS4 v[FOLD_VARIANTS];
+	BYTE a[4], b[4], set[4];
+	BOOL cased;
+	UCS4 c;
+
+	*at = *length = end = 0;
+	if (m == 0)
+		return TRUE;
+	kr = EN_GetKernels ();
+	if (kr -> utf8valid (needle, m) != m)
+		return FALSE;
+	// A needle with no character that has another case is found as it is.
+	cased = FALSE;
+	for (i = 0; fold && !cased && (i < m); ) {
+		c = EN_FindNext (needle, m, &i);
+		cased = c < 0x80 ? ((c | 0x20) >= 'a') && ((c | 0x20) <= 'z') : EN_CaseVariants (c, v) > 1;
+	}
+	if (cased) {
+		// The first anchor is the last byte of a character, the first one
+		// followed by a character with variants of a single length, and the
+		// second one the last byte of the furthest character at a fixed
+		// offset from it. The text before the first anchor is matched back.
+		shortest = longest = 0;
+		for (i = 0; ; ) {
+			EN_FoldSet (EN_FindNext (needle, m, &i), a, &k, &j);
+			shortest += k;
+			longest += j;
+			memcpy (b, a, sizeof (b));
+			for (split = j = i; j < m; j = k) {
+				k = j;
+				EN_FoldSet (EN_FindNext (needle, m, &k), set, &lo, &hi);
+				if (lo != hi)
+					break;
+				memcpy (b, set, sizeof (b));
+			}
+			if ((j > split) || (i == m))
+				break;
+		}
+		*at = EN_FindFolded (kr, s, n, needle, m, split, a, b, j - split, shortest, longest, &end);
+		if (*at == n) {
+			*at = 0;
+			return FALSE;
+		}
+		*length = end - *at;
+		return TRUE;
+	}
+	if ((m > n) || ((*at = EN_FindExact (kr, s, n, needle, m)) == n)) {
+		*at = 0;
+		return FALSE;
+	}
+	*length = m;
+
+	return TRUE;
+}
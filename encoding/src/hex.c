@@ -0,0 +1,80 @@
+/*
+	File: hex.c
+	Creation: 19-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Hex encoding and decoding of binary data, two digits per byte with the
+		high nibble first. Decoding takes digits of either case and nothing
+		else.
+*/
+
+#include "kernels.h"
+
+/*
+	Encodes the unread part of "in" as hex digits on "out".
+
+	[Params]
+
+		in: binary input. "index" advances over the bytes taken.
+		out: text output. "index" advances over the written digits.
+		upper: uppercase digits instead of lowercase.
+
+	[Return]
+
+		TRUE if all of "in" was taken, FALSE with "out -> eob" set if output is
+		full. It can be resumed with more room on "out".
+*/
+BOOL EN_HexEncode (struct ENCSTREAM* in, struct ENCSTREAM* out, BOOL upper) {
+	unsigned int n, m, r;
+
+	n = in -> size - in -> index;
+	m = EN_StreamRoom (out, 2ULL * n);
+	r = EN_GetKernels () -> hexencode (in -> buffer + in -> index, n, out -> buffer + out -> index, m, upper);
+	in -> index += r;
+	out -> index += 2 * r;
+	if (r < n) {
+		out -> eob = TRUE;
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/*
+	Decodes the unread part of hex text "in" on "out".
+
+	[Params]
+
+		in: text input. "index" advances over the digits taken.
+		out: binary output. "index" advances over the written bytes.
+
+	[Return]
+
+		TRUE if all of "in" was taken. FALSE if output is full ("out -> eob"
+		set), if input ends in half a byte ("in -> eob" set, "in -> index" on
+		it), both resumable, or on a character that isn't a hex digit, with
+		"in -> index" on it.
+*/
+BOOL EN_HexDecode (struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	unsigned int n, m, r;
+
+	n = (in -> size - in -> index) & ~1U;
+	m = EN_StreamRoom (out, n / 2);
+	r = EN_GetKernels () -> hexdecode (in -> buffer + in -> index, n, out -> buffer + out -> index, m);
+	in -> index += r;
+	out -> index += r / 2;
+	if (r < n) {
+		if (r / 2 == m)
+			out -> eob = TRUE;
+		else if (EN_HexValue (in -> buffer[in -> index]) != 0xFF)
+			in -> index++;
+		return FALSE;
+	}
+	if (in -> index < in -> size) {
+		in -> eob = TRUE;
+		return FALSE;
+	}
+
+	return TRUE;
+}
@@ -0,0 +1,914 @@
+/*
+	File: kavx2.c
+	Creation: 18-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		AVX2 kernels (32 byte blocks).
+*/
+
+#include "kernels.h"
+
+#ifdef EN_X86_KERNELS
+
+#include <immintrin.h>
+
+#define AVX2 __attribute__ ((target ("avx2")))
+
+static inline AVX2 __m256i EN_AVX2Swap16 (__m256i v) {
+	return _mm256_or_si256 (_mm256_slli_epi16 (v, 8), _mm256_srli_epi16 (v, 8));
+}
+
+static inline AVX2 __m256i EN_AVX2Table (const void* t) {
+	return _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i*) t));
+}
+
+static inline AVX2 unsigned int EN_AVX2SumBytes (__m256i acc) {
+	__m256i t;
+
+	t = _mm256_sad_epu8 (acc, _mm256_setzero_si256 ());
+
+	return (unsigned int) (_mm256_extract_epi64 (t, 0) + _mm256_extract_epi64 (t, 1) +
+			_mm256_extract_epi64 (t, 2) + _mm256_extract_epi64 (t, 3));
+}
+
+static AVX2 unsigned int EN_AVX2WidenASCII (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be) {
+	unsigned int i;
+	__m256i lo, hi;
+	__m128i v;
+
+	for (i = 0; (n - i >= 32) && (m - 2 * i >= 64); i += 32) {
+		lo = _mm256_loadu_si256 ((const __m256i*) (s + i));
+		if (_mm256_movemask_epi8 (lo))
+			break;
+		v = _mm256_castsi256_si128 (lo);
+		hi = _mm256_cvtepu8_epi16 (_mm256_extracti128_si256 (lo, 1));
+		lo = _mm256_cvtepu8_epi16 (v);
+		if (be) {
+			lo = EN_AVX2Swap16 (lo);
+			hi = EN_AVX2Swap16 (hi);
+		}
+		_mm256_storeu_si256 ((__m256i*) (d + 2 * i), lo);
+		_mm256_storeu_si256 ((__m256i*) (d + 2 * i + 32), hi);
+	}
+
+	return i;
+}
+
+/*
+	vpshufb masks that pack 2 lanes of 32 bits holding the UTF-8 bytes of a
+	character each into their first 1, 2 or 3 bytes. The index has a bit per
+	lane for 2 bytes or more, and then a bit per lane for 3 bytes. PACK123LEN
+	has the bytes left.
+*/
+static const BYTE PACK123[16][8] = {
+	{0, 4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0, 1, 4, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0, 4, 5, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0, 1, 4, 5, 0x80, 0x80, 0x80, 0x80},
+	{0, 4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0, 1, 2, 4, 0x80, 0x80, 0x80, 0x80},
+	{0, 4, 5, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0, 1, 2, 4, 5, 0x80, 0x80, 0x80},
+	{0, 4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0, 1, 4, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0, 4, 5, 6, 0x80, 0x80, 0x80, 0x80},
+	{0, 1, 4, 5, 6, 0x80, 0x80, 0x80},
+	{0, 4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0, 1, 2, 4, 0x80, 0x80, 0x80, 0x80},
+	{0, 4, 5, 6, 0x80, 0x80, 0x80, 0x80},
+	{0, 1, 2, 4, 5, 6, 0x80, 0x80}};
+
+static const BYTE PACK123LEN[16] = {2, 3, 3, 4, 2, 4, 3, 5, 2, 3, 4, 5, 2, 4, 4, 6};
+
+/*
+	Encodes the 4 low units of "v", none a surrogate, as UTF-8 on "d" and
+	returns the bytes written. Every unit is put on a 32 bit lane with its 1,
+	2 or 3 bytes, and the lanes are packed by pairs, every pair stored with 8
+	bytes.
+*/
+static inline AVX2 unsigned int EN_AVX2Encode3 (__m128i v, BYTE* d) {
+	__m128i x, lo, r, a, b;
+	unsigned int ka, kb, k, j;
+
+	x = _mm_cvtepu16_epi32 (v);
+	lo = _mm_slli_epi32 (_mm_or_si128 (_mm_and_si128 (x, _mm_set1_epi32 (0x3F)), _mm_set1_epi32 (0x80)), 8);
+	a = _mm_cmpgt_epi32 (x, _mm_set1_epi32 (0x7F));
+	b = _mm_cmpgt_epi32 (x, _mm_set1_epi32 (0x7FF));
+	// 2 bytes: 110xxxxx 10xxxxxx. 3 bytes: 1110xxxx 10xxxxxx 10xxxxxx.
+	r = _mm_blendv_epi8 (x, _mm_or_si128 (_mm_or_si128 (_mm_srli_epi32 (x, 6), _mm_set1_epi32 (0xC0)), lo), a);
+	r = _mm_blendv_epi8 (r, _mm_or_si128 (_mm_or_si128 (_mm_srli_epi32 (x, 12), _mm_set1_epi32 (0xE0)),
+			_mm_or_si128 (_mm_slli_epi32 (lo, 8), _mm_slli_epi32 (_mm_or_si128 (_mm_and_si128 (_mm_srli_epi32 (x, 6),
+			_mm_set1_epi32 (0x3F)), _mm_set1_epi32 (0x80)), 8))), b);
+	ka = (unsigned int) _mm_movemask_ps (_mm_castsi128_ps (a));
+	kb = (unsigned int) _mm_movemask_ps (_mm_castsi128_ps (b));
+	k = (ka & 3) | (kb & 3) << 2;
+	_mm_storel_epi64 ((__m128i*) d, _mm_shuffle_epi8 (r, _mm_loadl_epi64 ((const __m128i*) PACK123[k])));
+	j = PACK123LEN[k];
+	k = ka >> 2 | (kb >> 2) << 2;
+	_mm_storel_epi64 ((__m128i*) (d + j), _mm_shuffle_epi8 (_mm_srli_si128 (r, 8),
+			_mm_loadl_epi64 ((const __m128i*) PACK123[k])));
+
+	return j + PACK123LEN[k];
+}
+
+unsigned int AVX2 EN_AVX2NarrowUTF16 (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, unsigned int* w) {
+	unsigned int i, j;
+	__m256i v, t, z;
+	__m128i h;
+
+	z = _mm256_setzero_si256 ();
+	for (i = j = 0; n - i >= 32; i += 32) {
+		v = _mm256_loadu_si256 ((const __m256i*) (s + i));
+		if (be)
+			v = EN_AVX2Swap16 (v);
+		// ASCII block: 16 units below 0x80 narrow to 16 bytes.
+		t = _mm256_cmpeq_epi16 (_mm256_and_si256 (v, _mm256_set1_epi16 ((short) 0xFF80)), z);
+		if ((unsigned int) _mm256_movemask_epi8 (t) == 0xFFFFFFFF) {
+			if (m - j < 16)
+				break;
+			_mm_storeu_si128 ((__m128i*) (d + j), _mm_packus_epi16 (_mm256_castsi256_si128 (v),
+					_mm256_extracti128_si256 (v, 1)));
+			j += 16;
+			continue;
+		}
+		// Two byte block: 16 units in [0x80, 0x7FF] become 16 lead/trail pairs.
+		if ((_mm256_movemask_epi8 (t) == 0) &&
+				((unsigned int) _mm256_movemask_epi8 (_mm256_cmpeq_epi16 (_mm256_and_si256 (v,
+				_mm256_set1_epi16 ((short) 0xF800)), z)) == 0xFFFFFFFF)) {
+			if (m - j < 32)
+				break;
+			t = _mm256_or_si256 (_mm256_srli_epi16 (v, 6), _mm256_set1_epi16 (0x00C0));
+			t = _mm256_or_si256 (t, _mm256_slli_epi16 (_mm256_and_si256 (v, _mm256_set1_epi16 (0x003F)), 8));
+			_mm256_storeu_si256 ((__m256i*) (d + j), _mm256_or_si256 (t, _mm256_set1_epi16 ((short) 0x8000)));
+			j += 32;
+			continue;
+		}
+		// Mixed block of 1, 2 and 3 byte characters, by groups of 4, with room
+		// for 3 bytes each and the last store.
+		if (_mm256_movemask_epi8 (_mm256_cmpeq_epi16 (_mm256_and_si256 (v, _mm256_set1_epi16 ((short) 0xF800)),
+				_mm256_set1_epi16 ((short) 0xD800))) || (m - j < 56))
+			break;
+		h = _mm256_castsi256_si128 (v);
+		j += EN_AVX2Encode3 (h, d + j);
+		j += EN_AVX2Encode3 (_mm_srli_si128 (h, 8), d + j);
+		h = _mm256_extracti128_si256 (v, 1);
+		j += EN_AVX2Encode3 (h, d + j);
+		j += EN_AVX2Encode3 (_mm_srli_si128 (h, 8), d + j);
+	}
+	*w = j;
+
+	return i;
+}
+
+static AVX2 unsigned int EN_AVX2UTF8CountChars (const BYTE* s, unsigned int n) {
+	unsigned int i, c, k;
+	__m256i acc, v;
+
+	i = c = 0;
+	while (n - i >= 32) {
+		acc = _mm256_setzero_si256 ();
+		for (k = 0; (k < 255) && (n - i >= 32); k++, i += 32) {
+			v = _mm256_loadu_si256 ((const __m256i*) (s + i));
+			acc = _mm256_sub_epi8 (acc, _mm256_cmpgt_epi8 (v, _mm256_set1_epi8 (-65)));
+		}
+		c += EN_AVX2SumBytes (acc);
+	}
+
+	return c + EN_ScalarUTF8CountChars (s + i, n - i);
+}
+
+static AVX2 unsigned int EN_AVX2UTF8CountUTF16 (const BYTE* s, unsigned int n) {
+	unsigned int i, c, k;
+	__m256i acc, v, t;
+
+	i = c = 0;
+	while (n - i >= 32) {
+		acc = _mm256_setzero_si256 ();
+		for (k = 0; (k < 127) && (n - i >= 32); k++, i += 32) {
+			v = _mm256_loadu_si256 ((const __m256i*) (s + i));
+			acc = _mm256_sub_epi8 (acc, _mm256_cmpgt_epi8 (v, _mm256_set1_epi8 (-65)));
+			t = _mm256_cmpeq_epi8 (_mm256_and_si256 (v, _mm256_set1_epi8 ((char) 0xF8)), _mm256_set1_epi8 ((char) 0xF0));
+			acc = _mm256_sub_epi8 (acc, t);
+		}
+		c += EN_AVX2SumBytes (acc);
+	}
+
+	return c + EN_ScalarUTF8CountUTF16 (s + i, n - i);
+}
+
+unsigned int AVX2 EN_AVX2UTF16CountUTF8 (const BYTE* s, unsigned int n, BOOL be) {
+	unsigned int i, c, k;
+	__m256i acc, v, z, t;
+	__m128i h;
+
+	i = c = 0;
+	z = _mm256_setzero_si256 ();
+	while (n - i >= 32) {
+		acc = _mm256_setzero_si256 ();
+		for (k = 0; (k < 8192) && (n - i >= 32); k++, i += 32) {
+			v = _mm256_loadu_si256 ((const __m256i*) (s + i));
+			if (be)
+				v = EN_AVX2Swap16 (v);
+			acc = _mm256_add_epi16 (acc, _mm256_cmpeq_epi16 (_mm256_and_si256 (v, _mm256_set1_epi16 ((short) 0xFF80)), z));
+			acc = _mm256_add_epi16 (acc, _mm256_cmpeq_epi16 (_mm256_and_si256 (v, _mm256_set1_epi16 ((short) 0xF800)), z));
+			t = _mm256_cmpeq_epi16 (_mm256_and_si256 (v, _mm256_set1_epi16 ((short) 0xF800)), _mm256_set1_epi16 ((short) 0xD800));
+			acc = _mm256_add_epi16 (acc, t);
+		}
+		t = _mm256_madd_epi16 (acc, _mm256_set1_epi16 (-1));
+		h = _mm_add_epi32 (_mm256_castsi256_si128 (t), _mm256_extracti128_si256 (t, 1));
+		h = _mm_add_epi32 (h, _mm_srli_si128 (h, 8));
+		h = _mm_add_epi32 (h, _mm_srli_si128 (h, 4));
+		c += 3 * (k * 16) - (unsigned int) _mm_cvtsi128_si32 (h);
+	}
+
+	return c + EN_ScalarUTF16CountUTF8 (s + i, n - i, be);
+}
+
+unsigned int AVX2 EN_AVX2UCS4CountUTF8 (const UCS4* s, unsigned int n) {
+	unsigned int i;
+	__m256i acc, v;
+	__m128i h;
+
+	acc = _mm256_setzero_si256 ();
+	for (i = 0; n - i >= 8; i += 8) {
+		v = _mm256_loadu_si256 ((const __m256i*) (s + i));
+		acc = _mm256_sub_epi32 (acc, _mm256_cmpgt_epi32 (v, _mm256_set1_epi32 (0x0000007F)));
+		acc = _mm256_sub_epi32 (acc, _mm256_cmpgt_epi32 (v, _mm256_set1_epi32 (0x000007FF)));
+		acc = _mm256_sub_epi32 (acc, _mm256_cmpgt_epi32 (v, _mm256_set1_epi32 (0x0000FFFF)));
+		acc = _mm256_sub_epi32 (acc, _mm256_cmpgt_epi32 (v, _mm256_set1_epi32 (0x001FFFFF)));
+		acc = _mm256_sub_epi32 (acc, _mm256_cmpgt_epi32 (v, _mm256_set1_epi32 (0x03FFFFFF)));
+	}
+	h = _mm_add_epi32 (_mm256_castsi256_si128 (acc), _mm256_extracti128_si256 (acc, 1));
+	h = _mm_add_epi32 (h, _mm_srli_si128 (h, 8));
+	h = _mm_add_epi32 (h, _mm_srli_si128 (h, 4));
+
+	return i + (unsigned int) _mm_cvtsi128_si32 (h) + EN_ScalarUCS4CountUTF8 (s + i, n - i);
+}
+
+/*
+	vpshufb masks by permutation, the same in both 128 bit lanes.
+*/
+static const BYTE PERMMASKS[3][16] = {
+	{1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14},
+	{2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13},
+	{3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12}};
+
+static AVX2 unsigned int EN_AVX2ByteOrder (const BYTE* s, unsigned int n, BYTE* d, enum BYTEPERM p) {
+	unsigned int i;
+	__m256i m, v0, v1;
+
+	m = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i*) PERMMASKS[p]));
+	// Two registers per iteration to keep loads and stores in flight.
+	for (i = 0; n - i >= 64; i += 64) {
+		v0 = _mm256_loadu_si256 ((const __m256i*) (s + i));
+		v1 = _mm256_loadu_si256 ((const __m256i*) (s + i + 32));
+		_mm256_storeu_si256 ((__m256i*) (d + i), _mm256_shuffle_epi8 (v0, m));
+		_mm256_storeu_si256 ((__m256i*) (d + i + 32), _mm256_shuffle_epi8 (v1, m));
+	}
+	for (; n - i >= 32; i += 32) {
+		v0 = _mm256_loadu_si256 ((const __m256i*) (s + i));
+		_mm256_storeu_si256 ((__m256i*) (d + i), _mm256_shuffle_epi8 (v0, m));
+	}
+
+	return i;
+}
+
+void AVX2 EN_AVX2ZeroCount (const BYTE* s, unsigned int n, unsigned int* z) {
+	unsigned int i, k, p;
+	__m256i acc, t;
+	__m128i h;
+
+	i = 0;
+	while (n - i >= 32) {
+		acc = _mm256_setzero_si256 ();
+		for (k = 0; (k < 255) && (n - i >= 32); k++, i += 32)
+			acc = _mm256_sub_epi8 (acc, _mm256_cmpeq_epi8 (_mm256_loadu_si256 ((const __m256i*) (s + i)),
+					_mm256_setzero_si256 ()));
+		for (p = 0; p < 4; p++) {
+			t = _mm256_and_si256 (_mm256_srli_epi32 (acc, 8 * p), _mm256_set1_epi32 (0xFF));
+			h = _mm_add_epi32 (_mm256_castsi256_si128 (t), _mm256_extracti128_si256 (t, 1));
+			h = _mm_add_epi32 (h, _mm_srli_si128 (h, 8));
+			h = _mm_add_epi32 (h, _mm_srli_si128 (h, 4));
+			z[p] += (unsigned int) _mm_cvtsi128_si32 (h);
+		}
+	}
+	EN_ScalarZeroCount (s + i, n - i, z);
+}
+
+/*
+	UTF-8 validation by byte pair classification, after Keiser and Lemire,
+	"Validating UTF-8 In Less Than One Instruction Per Byte" (2021). Every pair
+	of consecutive bytes is classified with three 16 entry nibble lookups, and
+	an error bit survives the "and" of the three only for an invalid pair.
+	Third and fourth bytes of a sequence are checked apart.
+*/
+#define U8_TOO_SHORT (1 << 0)
+#define U8_TOO_LONG (1 << 1)
+#define U8_OVERLONG_3 (1 << 2)
+#define U8_TOO_LARGE (1 << 3)
+#define U8_SURROGATE (1 << 4)
+#define U8_OVERLONG_2 (1 << 5)
+#define U8_TOO_LARGE_1000 (1 << 6)
+#define U8_OVERLONG_4 (1 << 6)
+#define U8_TWO_CONTS (1 << 7)
+#define U8_CARRY (U8_TOO_SHORT | U8_TOO_LONG | U8_TWO_CONTS)
+
+// Indexed by the high nibble of the first byte of the pair.
+static const BYTE U8BYTE1HIGH[16] = {
+	U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG,
+	U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG,
+	U8_TWO_CONTS, U8_TWO_CONTS, U8_TWO_CONTS, U8_TWO_CONTS,
+	U8_TOO_SHORT | U8_OVERLONG_2,
+	U8_TOO_SHORT,
+	U8_TOO_SHORT | U8_OVERLONG_3 | U8_SURROGATE,
+	U8_TOO_SHORT | U8_TOO_LARGE | U8_TOO_LARGE_1000 | U8_OVERLONG_4};
+
+// Indexed by the low nibble of the first byte of the pair.
+static const BYTE U8BYTE1LOW[16] = {
+	U8_CARRY | U8_OVERLONG_3 | U8_OVERLONG_2 | U8_OVERLONG_4,
+	U8_CARRY | U8_OVERLONG_2,
+	U8_CARRY,
+	U8_CARRY,
+	U8_CARRY | U8_TOO_LARGE,
+	U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+	U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+	U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+	U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+	U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+	U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+	U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+	U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+	U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000 | U8_SURROGATE,
+	U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+	U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000};
+
+// Indexed by the high nibble of the second byte of the pair.
+static const BYTE U8BYTE2HIGH[16] = {
+	U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT,
+	U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT,
+	U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_OVERLONG_3 | U8_TOO_LARGE_1000 | U8_OVERLONG_4,
+	U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_OVERLONG_3 | U8_TOO_LARGE,
+	U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_SURROGATE | U8_TOO_LARGE,
+	U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_SURROGATE | U8_TOO_LARGE,
+	U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT};
+
+// Bytes of "v" shifted "k" places, taking the last ones of "p" in.
+#define AVX2_PREV(v, p, k) _mm256_alignr_epi8 ((v), _mm256_permute2x128_si256 ((p), (v), 0x21), 16 - (k))
+
+/*
+	Returns the error bits of block "v" preceded by block "p".
+*/
+static inline AVX2 __m256i EN_AVX2UTF8Errors (__m256i v, __m256i p, __m256i t1h, __m256i t1l, __m256i t2h) {
+	__m256i p1, lo, sc, must;
+
+	lo = _mm256_set1_epi8 (0x0F);
+	p1 = AVX2_PREV (v, p, 1);
+	sc = _mm256_shuffle_epi8 (t1h, _mm256_and_si256 (_mm256_srli_epi16 (p1, 4), lo));
+	sc = _mm256_and_si256 (sc, _mm256_shuffle_epi8 (t1l, _mm256_and_si256 (p1, lo)));
+	sc = _mm256_and_si256 (sc, _mm256_shuffle_epi8 (t2h, _mm256_and_si256 (_mm256_srli_epi16 (v, 4), lo)));
+	// Third and fourth bytes must be continuations.
+	must = _mm256_or_si256 (_mm256_subs_epu8 (AVX2_PREV (v, p, 2), _mm256_set1_epi8 ((char) (0xE0 - 0x80))),
+			_mm256_subs_epu8 (AVX2_PREV (v, p, 3), _mm256_set1_epi8 ((char) (0xF0 - 0x80))));
+
+	return _mm256_xor_si256 (_mm256_and_si256 (must, _mm256_set1_epi8 ((char) 0x80)), sc);
+}
+
+/*
+	Blocks with errors are checked again by the scalar kernel, up to the next
+	block, and the vector loop goes on if they were only cut sequences.
+*/
+unsigned int AVX2 EN_AVX2UTF8Valid (const BYTE* s, unsigned int n) {
+	unsigned int i, k, w;
+	__m256i v, p, t1h, t1l, t2h, inc;
+
+	t1h = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i*) U8BYTE1HIGH));
+	t1l = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i*) U8BYTE1LOW));
+	t2h = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i*) U8BYTE2HIGH));
+	// Bytes that, at the end of a block, start a sequence not yet complete.
+	inc = _mm256_setr_epi8 (-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char) (0xF0 - 1), (char) (0xE0 - 1), (char) (0xC0 - 1));
+	i = 0;
+	for (;;) {
+		// A character boundary behaves as if ASCII came before.
+		p = _mm256_setzero_si256 ();
+		for (; n - i >= 32; i += 32) {
+			v = _mm256_loadu_si256 ((const __m256i*) (s + i));
+			if (!_mm256_movemask_epi8 (v)) {
+				// An ASCII block is only wrong if the previous one left a sequence open.
+				if (!_mm256_testz_si256 (_mm256_subs_epu8 (p, inc), _mm256_subs_epu8 (p, inc)))
+					break;
+			} else if (!_mm256_testz_si256 (EN_AVX2UTF8Errors (v, p, t1h, t1l, t2h),
+					EN_AVX2UTF8Errors (v, p, t1h, t1l, t2h)))
+				break;
+			p = v;
+		}
+		// Back off to the start of a sequence cut by the last block end.
+		for (k = 1; (k <= 3) && (k <= i); k++)
+			if ((s[i - k] & 0xC0) != 0x80) {
+				if ((s[i - k] >= 0xC0) && (k < (s[i - k] >= 0xF0 ? 4u : s[i - k] >= 0xE0 ? 3u : 2u)))
+					i -= k;
+				break;
+			}
+		if (n - i < 64)
+			return i + EN_ScalarUTF8Valid (s + i, n - i);
+		w = EN_ScalarUTF8Valid (s + i, 64);
+		if (w < 64 - 3)
+			return i + w;
+		i += w;
+	}
+}
+
+/*
+	vpshufb masks that pack the 16 bit lanes of 4 whose bit is set in the
+	index. PACK16LEN has the bytes left.
+*/
+static const BYTE PACK16[16][8] = {
+	{0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0, 1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{2, 3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0, 1, 2, 3, 0x80, 0x80, 0x80, 0x80},
+	{4, 5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0, 1, 4, 5, 0x80, 0x80, 0x80, 0x80},
+	{2, 3, 4, 5, 0x80, 0x80, 0x80, 0x80},
+	{0, 1, 2, 3, 4, 5, 0x80, 0x80},
+	{6, 7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0, 1, 6, 7, 0x80, 0x80, 0x80, 0x80},
+	{2, 3, 6, 7, 0x80, 0x80, 0x80, 0x80},
+	{0, 1, 2, 3, 6, 7, 0x80, 0x80},
+	{4, 5, 6, 7, 0x80, 0x80, 0x80, 0x80},
+	{0, 1, 4, 5, 6, 7, 0x80, 0x80},
+	{2, 3, 4, 5, 6, 7, 0x80, 0x80},
+	{0, 1, 2, 3, 4, 5, 6, 7}};
+
+static const BYTE PACK16LEN[16] = {0, 2, 2, 4, 2, 4, 4, 6, 2, 4, 4, 6, 4, 6, 6, 8};
+
+/*
+	Decodes blocks of 32 bytes, starting on a character boundary, up to the
+	end of their last whole character. The pairs of bytes up to the one after
+	the block are checked as EN_AVX2UTF8Valid() does, and the block is left to
+	the caller on any error or 4 byte character. Every byte that ends a
+	character gets its code point on a 16 bit lane, from itself and the 2
+	bytes before, and those lanes are packed by groups of 4.
+*/
+unsigned int AVX2 EN_AVX2WidenUTF8 (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be,
+			unsigned int* w) {
+	unsigned int i, j, e, g, k, ends;
+	__m256i v, x, p1, p2, lo, mid, top, ascii, t1h, t1l, t2h, nib, z;
+	__m128i c;
+
+	t1h = EN_AVX2Table (U8BYTE1HIGH);
+	t1l = EN_AVX2Table (U8BYTE1LOW);
+	t2h = EN_AVX2Table (U8BYTE2HIGH);
+	nib = _mm256_set1_epi8 (0x0F);
+	z = _mm256_setzero_si256 ();
+	for (i = j = 0; (n - i >= 33) && (m - j >= 72) && ((s[i] & 0xC0) != 0x80); i += e) {
+		v = _mm256_loadu_si256 ((const __m256i*) (s + i));
+		if (!_mm256_movemask_epi8 (v)) {
+			lo = _mm256_cvtepu8_epi16 (_mm256_castsi256_si128 (v));
+			mid = _mm256_cvtepu8_epi16 (_mm256_extracti128_si256 (v, 1));
+			if (be) {
+				lo = EN_AVX2Swap16 (lo);
+				mid = EN_AVX2Swap16 (mid);
+			}
+			_mm256_storeu_si256 ((__m256i*) (d + j), lo);
+			_mm256_storeu_si256 ((__m256i*) (d + j + 32), mid);
+			j += 64;
+			e = 32;
+			continue;
+		}
+		// Bytes 1 to 32 of the block, after bytes 0 to 31, 2 before and 3 before.
+		x = _mm256_loadu_si256 ((const __m256i*) (s + i + 1));
+		p1 = AVX2_PREV (v, z, 1);
+		p2 = AVX2_PREV (v, z, 2);
+		lo = _mm256_shuffle_epi8 (t1h, _mm256_and_si256 (_mm256_srli_epi16 (v, 4), nib));
+		lo = _mm256_and_si256 (lo, _mm256_shuffle_epi8 (t1l, _mm256_and_si256 (v, nib)));
+		lo = _mm256_and_si256 (lo, _mm256_shuffle_epi8 (t2h, _mm256_and_si256 (_mm256_srli_epi16 (x, 4), nib)));
+		top = _mm256_or_si256 (_mm256_subs_epu8 (p1, _mm256_set1_epi8 ((char) (0xE0 - 0x80))),
+				_mm256_subs_epu8 (p2, _mm256_set1_epi8 ((char) (0xF0 - 0x80))));
+		lo = _mm256_xor_si256 (_mm256_and_si256 (top, _mm256_set1_epi8 ((char) 0x80)), lo);
+		if (!_mm256_testz_si256 (lo, lo) || _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (_mm256_max_epu8 (v,
+				_mm256_set1_epi8 ((char) 0xF0)), v)))
+			break;
+		// Bytes followed by one that isn't a continuation end a character.
+		ends = ~(unsigned int) _mm256_movemask_epi8 (_mm256_cmpgt_epi8 (_mm256_set1_epi8 (-64), x));
+		e = 32 - (unsigned int) __builtin_clz (ends);
+		// ASCII is itself, the rest 6 bits of the byte and 6 of the one before,
+		// and 4 of the one before that if this is the third.
+		ascii = _mm256_cmpgt_epi8 (v, _mm256_set1_epi8 (-1));
+		lo = _mm256_blendv_epi8 (_mm256_and_si256 (v, _mm256_set1_epi8 (0x3F)), v, ascii);
+		mid = _mm256_andnot_si256 (ascii, _mm256_and_si256 (p1, _mm256_set1_epi8 (0x3F)));
+		top = _mm256_and_si256 (_mm256_cmpgt_epi8 (_mm256_set1_epi8 (-64), p1), _mm256_and_si256 (p2, nib));
+		top = _mm256_andnot_si256 (ascii, top);
+		for (g = 0; g < 4; g++) {
+			c = _mm_or_si128 (_mm_cvtepu8_epi16 (_mm256_castsi256_si128 (lo)),
+					_mm_slli_epi16 (_mm_cvtepu8_epi16 (_mm256_castsi256_si128 (mid)), 6));
+			c = _mm_or_si128 (c, _mm_slli_epi16 (_mm_cvtepu8_epi16 (_mm256_castsi256_si128 (top)), 12));
+			if (be)
+				c = _mm_or_si128 (_mm_slli_epi16 (c, 8), _mm_srli_epi16 (c, 8));
+			k = ends >> 8 * g & 0x0F;
+			_mm_storel_epi64 ((__m128i*) (d + j), _mm_shuffle_epi8 (c, _mm_loadl_epi64 ((const __m128i*) PACK16[k])));
+			j += PACK16LEN[k];
+			k = ends >> (8 * g + 4) & 0x0F;
+			_mm_storel_epi64 ((__m128i*) (d + j), _mm_shuffle_epi8 (_mm_srli_si128 (c, 8),
+					_mm_loadl_epi64 ((const __m128i*) PACK16[k])));
+			j += PACK16LEN[k];
+			// Next 8 bytes to the bottom.
+			lo = _mm256_permute4x64_epi64 (lo, 0x39);
+			mid = _mm256_permute4x64_epi64 (mid, 0x39);
+			top = _mm256_permute4x64_epi64 (top, 0x39);
+		}
+	}
+	*w = j;
+
+	return i;
+}
+
+/*
+	Two registers per iteration, as EN_AVX2ByteOrder().
+*/
+static AVX2 unsigned int EN_AVX2ASCIICopy (const BYTE* s, unsigned int n, BYTE* d, unsigned int m) {
+	unsigned int i;
+	__m256i v0, v1;
+
+	for (i = 0; (n - i >= 64) && (m - i >= 64); i += 64) {
+		v0 = _mm256_loadu_si256 ((const __m256i*) (s + i));
+		v1 = _mm256_loadu_si256 ((const __m256i*) (s + i + 32));
+		if (_mm256_movemask_epi8 (_mm256_or_si256 (v0, v1)))
+			break;
+		_mm256_storeu_si256 ((__m256i*) (d + i), v0);
+		_mm256_storeu_si256 ((__m256i*) (d + i + 32), v1);
+	}
+	for (; (n - i >= 32) && (m - i >= 32); i += 32) {
+		v0 = _mm256_loadu_si256 ((const __m256i*) (s + i));
+		if (_mm256_movemask_epi8 (v0))
+			break;
+		_mm256_storeu_si256 ((__m256i*) (d + i), v0);
+	}
+
+	return i;
+}
+
+static inline AVX2 int EN_AVX2SBMapped (__m256i v, enum ENCODING e) {
+	switch (e) {
+		case ENC_ASCII:
+			return _mm256_movemask_epi8 (v);
+		case ENC_CP1252:
+			return _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (_mm256_and_si256 (v, _mm256_set1_epi8 ((char) 0xE0)),
+					_mm256_set1_epi8 ((char) 0x80)));
+		default:
+			return 0;
+	}
+}
+
+static AVX2 unsigned int EN_AVX2WidenSB (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, enum ENCODING e) {
+	unsigned int i;
+	__m256i lo, hi;
+
+	for (i = 0; (n - i >= 32) && (m - 2 * i >= 64); i += 32) {
+		lo = _mm256_loadu_si256 ((const __m256i*) (s + i));
+		if (EN_AVX2SBMapped (lo, e))
+			break;
+		hi = _mm256_cvtepu8_epi16 (_mm256_extracti128_si256 (lo, 1));
+		lo = _mm256_cvtepu8_epi16 (_mm256_castsi256_si128 (lo));
+		if (be) {
+			lo = EN_AVX2Swap16 (lo);
+			hi = EN_AVX2Swap16 (hi);
+		}
+		_mm256_storeu_si256 ((__m256i*) (d + 2 * i), lo);
+		_mm256_storeu_si256 ((__m256i*) (d + 2 * i + 32), hi);
+	}
+
+	return i;
+}
+
+unsigned int AVX2 EN_AVX2NarrowSB (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, enum ENCODING e) {
+	unsigned int i;
+	__m256i v, hi, c1, z;
+
+	z = _mm256_setzero_si256 ();
+	hi = _mm256_set1_epi16 ((short) (e == ENC_ASCII ? 0xFF80 : 0xFF00));
+	c1 = _mm256_set1_epi16 ((short) (e == ENC_CP1252 ? 0x0080 : 0xFFFF));
+	for (i = 0; (n - i >= 32) && (m - i / 2 >= 16); i += 32) {
+		v = _mm256_loadu_si256 ((const __m256i*) (s + i));
+		if (be)
+			v = EN_AVX2Swap16 (v);
+		if (((unsigned int) _mm256_movemask_epi8 (_mm256_cmpeq_epi16 (_mm256_and_si256 (v, hi), z)) != 0xFFFFFFFF) ||
+				_mm256_movemask_epi8 (_mm256_cmpeq_epi16 (_mm256_and_si256 (v, _mm256_set1_epi16 ((short) 0xFFE0)), c1)))
+			break;
+		_mm_storeu_si128 ((__m128i*) (d + i / 2), _mm_packus_epi16 (_mm256_castsi256_si128 (v),
+				_mm256_extracti128_si256 (v, 1)));
+	}
+
+	return i;
+}
+
+/*
+	vpshufb masks that pack 4 lanes of 16 bits into their low byte, and their
+	high byte too for the lanes whose bit is set in the index. PACK12LEN has
+	the bytes left.
+*/
+static const BYTE PACK12[16][8] = {
+	{0, 2, 4, 6, 0x80, 0x80, 0x80, 0x80},
+	{0, 1, 2, 4, 6, 0x80, 0x80, 0x80},
+	{0, 2, 3, 4, 6, 0x80, 0x80, 0x80},
+	{0, 1, 2, 3, 4, 6, 0x80, 0x80},
+	{0, 2, 4, 5, 6, 0x80, 0x80, 0x80},
+	{0, 1, 2, 4, 5, 6, 0x80, 0x80},
+	{0, 2, 3, 4, 5, 6, 0x80, 0x80},
+	{0, 1, 2, 3, 4, 5, 6, 0x80},
+	{0, 2, 4, 6, 7, 0x80, 0x80, 0x80},
+	{0, 1, 2, 4, 6, 7, 0x80, 0x80},
+	{0, 2, 3, 4, 6, 7, 0x80, 0x80},
+	{0, 1, 2, 3, 4, 6, 7, 0x80},
+	{0, 2, 4, 5, 6, 7, 0x80, 0x80},
+	{0, 1, 2, 4, 5, 6, 7, 0x80},
+	{0, 2, 3, 4, 5, 6, 7, 0x80},
+	{0, 1, 2, 3, 4, 5, 6, 7}};
+
+static const BYTE PACK12LEN[16] = {4, 5, 5, 6, 5, 6, 6, 7, 5, 6, 6, 7, 6, 7, 7, 8};
+
+/*
+	Mixed blocks are widened to 16 bit lanes holding both UTF-8 bytes of
+	every character (the second one unused for ASCII), and packed by groups
+	of 4 lanes. Every group is stored with 8 bytes, the next one overwrites
+	what's beyond its length.
+*/
+unsigned int AVX2 EN_AVX2SBToUTF8 (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, enum ENCODING e, unsigned int* w) {
+	unsigned int i, j, h, k;
+	__m128i v, x, t, u;
+
+	for (i = j = 0; (n - i >= 16) && (m - j >= 32); i += 16) {
+		v = _mm_loadu_si128 ((const __m128i*) (s + i));
+		if (!_mm_movemask_epi8 (v)) {
+			_mm_storeu_si128 ((__m128i*) (d + j), v);
+			j += 16;
+			continue;
+		}
+		if (EN_AVX2SBMapped (_mm256_castsi128_si256 (v), e) & 0xFFFF)
+			break;
+		for (h = 0; h < 2; h++) {
+			x = _mm_cvtepu8_epi16 (h ? _mm_srli_si128 (v, 8) : v);
+			t = _mm_or_si128 (_mm_srli_epi16 (x, 6), _mm_set1_epi16 (0x00C0));
+			t = _mm_or_si128 (t, _mm_slli_epi16 (_mm_or_si128 (_mm_and_si128 (x, _mm_set1_epi16 (0x003F)),
+					_mm_set1_epi16 (0x0080)), 8));
+			u = _mm_cmpgt_epi16 (x, _mm_set1_epi16 (0x007F));
+			t = _mm_blendv_epi8 (x, t, u);
+			k = (unsigned int) _mm_movemask_epi8 (_mm_packs_epi16 (u, u)) & 0xFF;
+			_mm_storel_epi64 ((__m128i*) (d + j), _mm_shuffle_epi8 (t, _mm_loadl_epi64 ((const __m128i*) PACK12[k & 15])));
+			j += PACK12LEN[k & 15];
+			_mm_storel_epi64 ((__m128i*) (d + j), _mm_shuffle_epi8 (_mm_srli_si128 (t, 8),
+					_mm_loadl_epi64 ((const __m128i*) PACK12[k >> 4])));
+			j += PACK12LEN[k >> 4];
+		}
+	}
+	*w = j;
+
+	return i;
+}
+
+/*
+	Base64 tables by enum ENB64, the same for both lanes:
+
+	B64OFFSETS: what to add to a value to get its character, by range: 0 for
+		A-Z, 1 for a-z, 2-11 for the digits, 12 and 13 for the last two.
+	B64CLASSLO, B64CLASSHI: a character is in the alphabet when the entries of
+		its low and high nibbles have no bit in common.
+	B64SHIFT: what to add to a character to get its value, by high nibble. The
+		last character of the alphabet shares it with others and goes to 8 plus
+		its high nibble instead (B64LAST).
+*/
+static const signed char B64OFFSETS[2][16] = {
+	{65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0},
+	{65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -17, 32, 0, 0}};
+static const BYTE B64CLASSLO[2][16] = {
+	{0x0B, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x07, 0x15, 0x17, 0x17, 0x17, 0x15},
+	{0x0B, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x07, 0x37, 0x37, 0x35, 0x37, 0x27}};
+static const BYTE B64CLASSHI[2][16] = {
+	{0x01, 0x01, 0x02, 0x04, 0x08, 0x10, 0x08, 0x10, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01},
+	{0x01, 0x01, 0x02, 0x04, 0x08, 0x10, 0x08, 0x20, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01}};
+static const signed char B64SHIFT[2][16] = {
+	{0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 16, 0, 0, 0, 0, 0},
+	{0, 0, 17, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, -32, 0, 0}};
+static const char B64LAST[2] = {'/', '_'};
+
+/*
+	Encodes 24 bytes to 32 characters per block. Every lane takes 12 bytes from
+	two loads 12 bytes apart, so a block reads 28 bytes.
+*/
+unsigned int AVX2 EN_AVX2B64Encode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, enum ENB64 a) {
+	__m256i v, t, offsets;
+	unsigned int i, j;
+
+	offsets = EN_AVX2Table (B64OFFSETS[a]);
+	for (i = j = 0; (n - i >= 28) && (m - j >= 32); i += 24, j += 32) {
+		v = _mm256_inserti128_si256 (_mm256_castsi128_si256 (_mm_loadu_si128 ((const __m128i*) (s + i))),
+				_mm_loadu_si128 ((const __m128i*) (s + i + 12)), 1);
+		// Bytes 1, 0, 2, 1 of every group on a 32 bit lane, and its four 6 bit
+		// fields taken to their own bytes by multiplies.
+		v = _mm256_shuffle_epi8 (v, _mm256_setr_epi8 (1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+				1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+		t = _mm256_mulhi_epu16 (_mm256_and_si256 (v, _mm256_set1_epi32 (0x0FC0FC00)), _mm256_set1_epi32 (0x04000040));
+		v = _mm256_mullo_epi16 (_mm256_and_si256 (v, _mm256_set1_epi32 (0x003F03F0)), _mm256_set1_epi32 (0x01000010));
+		v = _mm256_or_si256 (t, v);
+		t = _mm256_subs_epu8 (v, _mm256_set1_epi8 (51));
+		t = _mm256_sub_epi8 (t, _mm256_cmpgt_epi8 (v, _mm256_set1_epi8 (25)));
+		_mm256_storeu_si256 ((__m256i*) (d + j), _mm256_add_epi8 (v, _mm256_shuffle_epi8 (offsets, t)));
+	}
+
+	return i + EN_ScalarB64Encode (s + i, n - i, d + j, m - j, a);
+}
+
+/*
+	Decodes 32 characters to 24 bytes per block. The block with a character out
+	of the alphabet is left to the scalar kernel, which stops on its group.
+*/
+unsigned int AVX2 EN_AVX2B64Decode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, enum ENB64 a) {
+	__m256i v, hi, lo, classlo, classhi, shift, last;
+	unsigned int i, j;
+
+	classlo = EN_AVX2Table (B64CLASSLO[a]);
+	classhi = EN_AVX2Table (B64CLASSHI[a]);
+	shift = EN_AVX2Table (B64SHIFT[a]);
+	last = _mm256_set1_epi8 (B64LAST[a]);
+	for (i = j = 0; (n - i >= 32) && (m - j >= 24); i += 32, j += 24) {
+		v = _mm256_loadu_si256 ((const __m256i*) (s + i));
+		hi = _mm256_and_si256 (_mm256_srli_epi16 (v, 4), _mm256_set1_epi8 (0x0F));
+		lo = _mm256_and_si256 (v, _mm256_set1_epi8 (0x0F));
+		if (!_mm256_testz_si256 (_mm256_shuffle_epi8 (classlo, lo), _mm256_shuffle_epi8 (classhi, hi)))
+			break;
+		hi = _mm256_or_si256 (hi, _mm256_and_si256 (_mm256_cmpeq_epi8 (v, last), _mm256_set1_epi8 (8)));
+		v = _mm256_add_epi8 (v, _mm256_shuffle_epi8 (shift, hi));
+		// Four 6 bit values to 24 bits on every 32 bit lane, then the 3 bytes of
+		// every lane packed, most significant first.
+		v = _mm256_maddubs_epi16 (v, _mm256_set1_epi32 (0x01400140));
+		v = _mm256_madd_epi16 (v, _mm256_set1_epi32 (0x00011000));
+		v = _mm256_shuffle_epi8 (v, _mm256_setr_epi8 (2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+				2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+		v = _mm256_permutevar8x32_epi32 (v, _mm256_setr_epi32 (0, 1, 2, 4, 5, 6, 3, 7));
+		_mm_storeu_si128 ((__m128i*) (d + j), _mm256_castsi256_si128 (v));
+		_mm_storel_epi64 ((__m128i*) (d + j + 16), _mm256_extracti128_si256 (v, 1));
+	}
+
+	return i + EN_ScalarB64Decode (s + i, n - i, d + j, m - j, a);
+}
+
+/*
+	Encodes 32 bytes to 64 hex digits per block. The quadwords are reordered
+	first so that the in-lane unpacks give the digits in order.
+*/
+unsigned int AVX2 EN_AVX2HexEncode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL upper) {
+	__m256i v, hi, lo, digits;
+	unsigned int i;
+
+	digits = EN_AVX2Table (upper ? "0123456789ABCDEF" : "0123456789abcdef");
+	for (i = 0; (n - i >= 32) && (m - 2 * i >= 64); i += 32) {
+		v = _mm256_permute4x64_epi64 (_mm256_loadu_si256 ((const __m256i*) (s + i)), 0xD8);
+		hi = _mm256_and_si256 (_mm256_srli_epi16 (v, 4), _mm256_set1_epi8 (0x0F));
+		lo = _mm256_and_si256 (v, _mm256_set1_epi8 (0x0F));
+		_mm256_storeu_si256 ((__m256i*) (d + 2 * i), _mm256_shuffle_epi8 (digits, _mm256_unpacklo_epi8 (hi, lo)));
+		_mm256_storeu_si256 ((__m256i*) (d + 2 * i + 32), _mm256_shuffle_epi8 (digits, _mm256_unpackhi_epi8 (hi, lo)));
+	}
+
+	return i + EN_ScalarHexEncode (s + i, n - i, d + 2 * i, m - 2 * i, upper);
+}
+
+/*
+	Decodes 32 hex digits to 16 bytes per block, as EN_SSE2HexDecode().
+*/
+unsigned int AVX2 EN_AVX2HexDecode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m) {
+	__m256i v, dg, isd, l, isl;
+	unsigned int i;
+
+	for (i = 0; (n - i >= 32) && (m - i / 2 >= 16); i += 32) {
+		v = _mm256_loadu_si256 ((const __m256i*) (s + i));
+		dg = _mm256_sub_epi8 (v, _mm256_set1_epi8 ('0'));
+		isd = _mm256_cmpeq_epi8 (_mm256_min_epu8 (dg, _mm256_set1_epi8 (9)), dg);
+		l = _mm256_sub_epi8 (_mm256_or_si256 (v, _mm256_set1_epi8 (0x20)), _mm256_set1_epi8 ('a'));
+		isl = _mm256_cmpeq_epi8 (_mm256_min_epu8 (l, _mm256_set1_epi8 (5)), l);
+		if ((unsigned int) _mm256_movemask_epi8 (_mm256_or_si256 (isd, isl)) != 0xFFFFFFFFU)
+			break;
+		v = _mm256_or_si256 (_mm256_and_si256 (isd, dg), _mm256_and_si256 (isl, _mm256_add_epi8 (l, _mm256_set1_epi8 (10))));
+		v = _mm256_or_si256 (_mm256_slli_epi16 (_mm256_and_si256 (v, _mm256_set1_epi16 (0x00FF)), 4), _mm256_srli_epi16 (v, 8));
+		_mm_storeu_si128 ((__m128i*) (d + i / 2), _mm_packus_epi16 (_mm256_castsi256_si128 (v), _mm256_extracti128_si256 (v, 1)));
+	}
+
+	return i + EN_ScalarHexDecode (s + i, n - i, d + i / 2, m - i / 2);
+}
+
+static inline AVX2 __m256i EN_AVX2Lower (__m256i v) {
+	__m256i upper;
+
+	upper = _mm256_and_si256 (_mm256_cmpgt_epi8 (v, _mm256_set1_epi8 ('A' - 1)),
+			_mm256_cmpgt_epi8 (_mm256_set1_epi8 ('Z' + 1), v));
+
+	return _mm256_or_si256 (v, _mm256_and_si256 (upper, _mm256_set1_epi8 (0x20)));
+}
+
+unsigned int AVX2 EN_AVX2LowerASCII (const BYTE* s, unsigned int n, BYTE* d, unsigned int m) {
+	unsigned int i;
+	__m256i v;
+
+	for (i = 0; (n - i >= 32) && (m - i >= 32); i += 32) {
+		v = _mm256_loadu_si256 ((const __m256i*) (s + i));
+		if (_mm256_movemask_epi8 (v))
+			break;
+		_mm256_storeu_si256 ((__m256i*) (d + i), EN_AVX2Lower (v));
+	}
+
+	return i;
+}
+
+unsigned int AVX2 EN_AVX2FoldASCII (const BYTE* a, const BYTE* b, unsigned int n) {
+	unsigned int i;
+	__m256i p, q;
+
+	for (i = 0; n - i >= 32; i += 32) {
+		p = _mm256_loadu_si256 ((const __m256i*) (a + i));
+		q = _mm256_loadu_si256 ((const __m256i*) (b + i));
+		if ((unsigned int) _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (p, q)) == 0xFFFFFFFFU)
+			continue;
+		if (_mm256_movemask_epi8 (_mm256_or_si256 (p, q)) ||
+				((unsigned int) _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (EN_AVX2Lower (p), EN_AVX2Lower (q))) != 0xFFFFFFFFU))
+			break;
+	}
+
+	return i;
+}
+
+static AVX2 unsigned int EN_AVX2SpanBelow (const BYTE* s, unsigned int n, BYTE limit) {
+	unsigned int i;
+	__m256i v, top;
+
+	top = _mm256_set1_epi8 ((char) (limit - 1));
+	for (i = 0; n - i >= 32; i += 32) {
+		v = _mm256_loadu_si256 ((const __m256i*) (s + i));
+		if ((unsigned int) _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (_mm256_min_epu8 (v, top), v)) != 0xFFFFFFFFU)
+			break;
+	}
+
+	return i;
+}
+
+static AVX2 unsigned int EN_AVX2FindPair (const BYTE* s, unsigned int n, BYTE a, BYTE b, unsigned int gap) {
+	unsigned int i;
+	__m256i va, vb;
+
+	va = _mm256_set1_epi8 ((char) a);
+	vb = _mm256_set1_epi8 ((char) b);
+	for (i = 0; n - gap - i >= 32; i += 32)
+		if (_mm256_movemask_epi8 (_mm256_and_si256 (_mm256_cmpeq_epi8 (_mm256_loadu_si256 ((const __m256i*) (s + i)), va),
+				_mm256_cmpeq_epi8 (_mm256_loadu_si256 ((const __m256i*) (s + i + gap)), vb))))
+			break;
+
+	return i;
+}
+
+static inline AVX2 __m256i EN_AVX2InSet (__m256i v, const __m256i* k) {
+	return _mm256_or_si256 (_mm256_or_si256 (_mm256_cmpeq_epi8 (v, k[0]), _mm256_cmpeq_epi8 (v, k[1])),
+			_mm256_or_si256 (_mm256_cmpeq_epi8 (v, k[2]), _mm256_cmpeq_epi8 (v, k[3])));
+}
+
+static AVX2 unsigned int EN_AVX2FindSets (const BYTE* s, unsigned int n, const BYTE* a, const BYTE* b, unsigned int gap) {
+	unsigned int i;
+	__m256i ka[4], kb[4];
+
+	for (i = 0; i < 4; i++) {
+		ka[i] = _mm256_set1_epi8 ((char) a[i]);
+		kb[i] = _mm256_set1_epi8 ((char) b[i]);
+	}
+	for (i = 0; n - gap - i >= 32; i += 32)
+		if (_mm256_movemask_epi8 (_mm256_and_si256 (EN_AVX2InSet (_mm256_loadu_si256 ((const __m256i*) (s + i)), ka),
+				EN_AVX2InSet (_mm256_loadu_si256 ((const __m256i*) (s + i + gap)), kb))))
+			break;
+
+	return i;
+}
+
+const struct ENKERNELS EN_AVX2Kernels = {
+	ISA_AVX2,
+	EN_AVX2WidenASCII,
+	EN_AVX2NarrowUTF16,
+	EN_AVX2WidenUTF8,
+	EN_AVX2UTF8CountChars,
+	EN_AVX2UTF8CountUTF16,
+	EN_AVX2UTF16CountUTF8,
+	EN_AVX2UCS4CountUTF8,
+	EN_AVX2ByteOrder,
+	EN_AVX2ZeroCount,
+	EN_AVX2UTF8Valid,
+	EN_AVX2ASCIICopy,
+	EN_AVX2WidenSB,
+	EN_AVX2NarrowSB,
+	EN_AVX2SBToUTF8,
+	EN_AVX2B64Encode,
+	EN_AVX2B64Decode,
+	EN_AVX2HexEncode,
+	EN_AVX2HexDecode,
+	EN_AVX2LowerASCII,
+	EN_AVX2FoldASCII,
+	EN_AVX2SpanBelow,
+	EN_AVX2FindPair,
+	EN_AVX2FindSets};
+
+#endif
@@ -0,0 +1,213 @@
+/*
+	File: kavx512.c
+	Creation: 18-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		AVX-512 (BW) kernels (64 byte blocks). Kernels that don't gain from the
+		wider registers are taken from the AVX2 table.
+*/
+
+#include "kernels.h"
+
+#ifdef EN_X86_KERNELS
+
+#include <immintrin.h>
+
+#define AVX512 __attribute__ ((target ("avx512f,avx512bw,popcnt")))
+
+static inline AVX512 __m512i EN_AVX512Swap16 (__m512i v) {
+	return _mm512_or_si512 (_mm512_slli_epi16 (v, 8), _mm512_srli_epi16 (v, 8));
+}
+
+static AVX512 unsigned int EN_AVX512WidenASCII (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be) {
+	unsigned int i;
+	__m512i v, lo, hi;
+
+	for (i = 0; (n - i >= 64) && (m - 2 * i >= 128); i += 64) {
+		v = _mm512_loadu_si512 ((const void*) (s + i));
+		if (_mm512_movepi8_mask (v))
+			break;
+		lo = _mm512_cvtepu8_epi16 (_mm512_castsi512_si256 (v));
+		hi = _mm512_cvtepu8_epi16 (_mm512_extracti64x4_epi64 (v, 1));
+		if (be) {
+			lo = EN_AVX512Swap16 (lo);
+			hi = EN_AVX512Swap16 (hi);
+		}
+		_mm512_storeu_si512 ((void*) (d + 2 * i), lo);
+		_mm512_storeu_si512 ((void*) (d + 2 * i + 64), hi);
+	}
+
+	return i;
+}
+
+/*
+	Compares give 64 bit masks, so counting is a population count per block.
+*/
+static AVX512 unsigned int EN_AVX512UTF8CountChars (const BYTE* s, unsigned int n) {
+	unsigned int i, c;
+	__m512i v;
+
+	for (i = c = 0; n - i >= 64; i += 64) {
+		v = _mm512_loadu_si512 ((const void*) (s + i));
+		c += (unsigned int) __builtin_popcountll (_mm512_cmpgt_epi8_mask (v, _mm512_set1_epi8 (-65)));
+	}
+
+	return c + EN_ScalarUTF8CountChars (s + i, n - i);
+}
+
+static AVX512 unsigned int EN_AVX512UTF8CountUTF16 (const BYTE* s, unsigned int n) {
+	unsigned int i, c;
+	__m512i v;
+
+	for (i = c = 0; n - i >= 64; i += 64) {
+		v = _mm512_loadu_si512 ((const void*) (s + i));
+		c += (unsigned int) __builtin_popcountll (_mm512_cmpgt_epi8_mask (v, _mm512_set1_epi8 (-65)));
+		c += (unsigned int) __builtin_popcountll (_mm512_cmpeq_epi8_mask (_mm512_and_si512 (v,
+				_mm512_set1_epi8 ((char) 0xF8)), _mm512_set1_epi8 ((char) 0xF0)));
+	}
+
+	return c + EN_ScalarUTF8CountUTF16 (s + i, n - i);
+}
+
+/*
+	vpshufb masks by permutation, the same in every 128 bit lane.
+*/
+static const BYTE PERMMASKS[3][16] = {
+	{1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14},
+	{2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13},
+	{3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12}};
+
+static AVX512 unsigned int EN_AVX512ByteOrder (const BYTE* s, unsigned int n, BYTE* d, enum BYTEPERM p) {
+	unsigned int i;
+	__m512i m, v;
+
+	m = _mm512_broadcast_i32x4 (_mm_loadu_si128 ((const __m128i*) PERMMASKS[p]));
+	for (i = 0; n - i >= 64; i += 64) {
+		v = _mm512_loadu_si512 ((const void*) (s + i));
+		_mm512_storeu_si512 ((void*) (d + i), _mm512_shuffle_epi8 (v, m));
+	}
+
+	return i;
+}
+
+static AVX512 unsigned int EN_AVX512ASCIICopy (const BYTE* s, unsigned int n, BYTE* d, unsigned int m) {
+	unsigned int i;
+	__m512i v;
+
+	for (i = 0; (n - i >= 64) && (m - i >= 64); i += 64) {
+		v = _mm512_loadu_si512 ((const void*) (s + i));
+		if (_mm512_movepi8_mask (v))
+			break;
+		_mm512_storeu_si512 ((void*) (d + i), v);
+	}
+
+	return i;
+}
+
+static inline AVX512 __mmask64 EN_AVX512SBMapped (__m512i v, enum ENCODING e) {
+	switch (e) {
+		case ENC_ASCII:
+			return _mm512_movepi8_mask (v);
+		case ENC_CP1252:
+			return _mm512_cmpeq_epi8_mask (_mm512_and_si512 (v, _mm512_set1_epi8 ((char) 0xE0)), _mm512_set1_epi8 ((char) 0x80));
+		default:
+			return 0;
+	}
+}
+
+static AVX512 unsigned int EN_AVX512WidenSB (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, enum ENCODING e) {
+	unsigned int i;
+	__m512i v, lo, hi;
+
+	for (i = 0; (n - i >= 64) && (m - 2 * i >= 128); i += 64) {
+		v = _mm512_loadu_si512 ((const void*) (s + i));
+		if (EN_AVX512SBMapped (v, e))
+			break;
+		lo = _mm512_cvtepu8_epi16 (_mm512_castsi512_si256 (v));
+		hi = _mm512_cvtepu8_epi16 (_mm512_extracti64x4_epi64 (v, 1));
+		if (be) {
+			lo = EN_AVX512Swap16 (lo);
+			hi = EN_AVX512Swap16 (hi);
+		}
+		_mm512_storeu_si512 ((void*) (d + 2 * i), lo);
+		_mm512_storeu_si512 ((void*) (d + 2 * i + 64), hi);
+	}
+
+	return i;
+}
+
+static AVX512 unsigned int EN_AVX512SpanBelow (const BYTE* s, unsigned int n, BYTE limit) {
+	unsigned int i;
+	__m512i lim;
+
+	lim = _mm512_set1_epi8 ((char) limit);
+	for (i = 0; n - i >= 64; i += 64)
+		if (_mm512_cmpge_epu8_mask (_mm512_loadu_si512 ((const void*) (s + i)), lim))
+			break;
+
+	return i;
+}
+
+static AVX512 unsigned int EN_AVX512FindPair (const BYTE* s, unsigned int n, BYTE a, BYTE b, unsigned int gap) {
+	unsigned int i;
+	__m512i va, vb;
+
+	va = _mm512_set1_epi8 ((char) a);
+	vb = _mm512_set1_epi8 ((char) b);
+	for (i = 0; n - gap - i >= 64; i += 64)
+		if (_mm512_cmpeq_epi8_mask (_mm512_loadu_si512 ((const void*) (s + i)), va) &
+				_mm512_cmpeq_epi8_mask (_mm512_loadu_si512 ((const void*) (s + i + gap)), vb))
+			break;
+
+	return i;
+}
+
+static inline AVX512 __mmask64 EN_AVX512InSet (__m512i v, const __m512i* k) {
+	return _mm512_cmpeq_epi8_mask (v, k[0]) | _mm512_cmpeq_epi8_mask (v, k[1]) | _mm512_cmpeq_epi8_mask (v, k[2]) |
+			_mm512_cmpeq_epi8_mask (v, k[3]);
+}
+
+static AVX512 unsigned int EN_AVX512FindSets (const BYTE* s, unsigned int n, const BYTE* a, const BYTE* b, unsigned int gap) {
+	unsigned int i;
+	__m512i ka[4], kb[4];
+
+	for (i = 0; i < 4; i++) {
+		ka[i] = _mm512_set1_epi8 ((char) a[i]);
+		kb[i] = _mm512_set1_epi8 ((char) b[i]);
+	}
+	for (i = 0; n - gap - i >= 64; i += 64)
+		if (EN_AVX512InSet (_mm512_loadu_si512 ((const void*) (s + i)), ka) &
+				EN_AVX512InSet (_mm512_loadu_si512 ((const void*) (s + i + gap)), kb))
+			break;
+
+	return i;
+}
+
+const struct ENKERNELS EN_AVX512Kernels = {
+	ISA_AVX512,
+	EN_AVX512WidenASCII,
+	EN_AVX2NarrowUTF16,
+	EN_AVX2WidenUTF8,
+	EN_AVX512UTF8CountChars,
+	EN_AVX512UTF8CountUTF16,
+	EN_AVX2UTF16CountUTF8,
+	EN_AVX2UCS4CountUTF8,
+	EN_AVX512ByteOrder,
+	EN_AVX2ZeroCount,
+	EN_AVX2UTF8Valid,
+	EN_AVX512ASCIICopy,
+	EN_AVX512WidenSB,
+	EN_AVX2NarrowSB,
+	EN_AVX2SBToUTF8,
+	EN_AVX2B64Encode,
+	EN_AVX2B64Decode,
+	EN_AVX2HexEncode,
+	EN_AVX2HexDecode,
+	EN_AVX2LowerASCII,
+	EN_AVX2FoldASCII,
+	EN_AVX512SpanBelow,
+	EN_AVX512FindPair,
+	EN_AVX512FindSets};
+
+#endif
@@ -0,0 +1,250 @@
+/*
+	File: kernels.h
+	Creation: 18-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Private declarations for the encoding kernels. Every instruction set
+		provides a table of block kernels, and dispatch.c binds the best one
+		the CPU supports.
+*/
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include "enciter.h"
+
+// x86-64 kernels are built with per function target attributes, so no special
+// compiler flags are needed and the whole binary runs on any x86-64 host.
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define EN_X86_KERNELS
+#endif
+
+// Byte permutations for byte order normalization.
+// PERM_SWAP16: 2 byte units reversed (21). Also 4 byte units in 2143 order.
+// PERM_SWAPHALVES: 4 byte units with their 2 byte halves swapped (3412).
+// PERM_SWAP32: 4 byte units reversed (4321).
+enum BYTEPERM {PERM_SWAP16, PERM_SWAPHALVES, PERM_SWAP32};
+
+// Result of a transcoding kernel.
+// TR_OK: all the input was consumed.
+// TR_INVALID: malformed input. "read" points to the erroneous sequence.
+// TR_SRCEND: input ends in the middle of a sequence. "read" points to its start.
+// TR_DSTEND: no space left on output. "read" points to the first unconverted unit.
+enum TRSTATUS {TR_OK, TR_INVALID, TR_SRCEND, TR_DSTEND};
+
+/*
+	Block kernels. Every one only processes whole blocks of its instruction set
+	width and leaves the tail to the caller, except the counting ones and
+	utf8valid that process the whole buffer.
+
+	widenascii: widens the longest run of ASCII blocks of UTF-8 "s" into UTF-16
+		"d" that fits on "m" bytes. Returns the bytes read (twice that is written).
+	narrowutf16: narrows the longest run of UTF-16 blocks of "s" with no
+		surrogates into UTF-8 "d". Kernels without byte shuffles only take
+		blocks that are all ASCII or all 2 byte characters. Returns the bytes
+		read and "w" the bytes written.
+	widenutf8: widens the longest run of UTF-8 blocks of "s", from a character
+		boundary, that are valid and have no 4 byte characters into UTF-16
+		"d" that fits on "m" bytes. A block is taken up to its last whole
+		character. Returns the bytes read and "w" the bytes written. Kernels
+		without byte shuffles take none.
+	byteorder: applies permutation "p" to the blocks of "s" and puts them on "d",
+		which may be "s" itself. Returns the bytes processed.
+	utf8valid: returns the length of the longest prefix of "s" that is valid
+		UTF-8 (RFC 3629) and ends on a character boundary, for the whole buffer.
+	zerocount: adds to "z[k]" the zero bytes of "s" at offsets equal to k modulo
+		4, for the whole buffer.
+	asciicopy: copies the longest run of ASCII blocks of "s" that fits on "m"
+		bytes into "d". Returns the bytes copied.
+	widensb: widens the longest run of blocks of single byte charset "e" whose
+		bytes all stand for their own value (see EN_SBIdentity()) into UTF-16
+		"d" that fits on "m" bytes. Returns the bytes read.
+	narrowsb: narrows the longest run of UTF-16 blocks of "s" whose units are
+		all bytes of charset "e" with their own value into "d" that fits on "m"
+		bytes. Returns the bytes read (half that is written).
+	sbtoutf8: as widensb, into UTF-8. Returns the bytes read and "w" the bytes
+		written.
+	b64encode: encodes the longest run of whole 3 byte groups of "s" that fits
+		on "m" bytes into Base64 alphabet "a" on "d", for the whole buffer.
+		Returns the bytes read (4 / 3 of that is written).
+	b64decode: decodes the longest run of whole 4 character groups of "s" that
+		are all in alphabet "a" (so no padding) and fits on "m" bytes into "d",
+		for the whole buffer. Returns the characters read (3 / 4 of that is
+		written).
+	hexencode: encodes the bytes of "s" that fit on "m" bytes as hex digit
+		pairs on "d", lowercase or "upper", for the whole buffer. Returns the
+		bytes read (twice that is written).
+	hexdecode: decodes the longest run of whole hex digit pairs of "s", in any
+		case, that fits on "m" bytes into "d", for the whole buffer. Returns the
+		characters read (half that is written).
+	lowerascii: copies the longest run of ASCII blocks of "s" that fits on "m"
+		bytes into "d" with 'A'-'Z' made lowercase. Returns the bytes copied.
+	foldascii: returns the length of the longest run of blocks of "a" and "b"
+		("n" bytes on both) that are the same, or ASCII and the same but for
+		the case of their letters. The run may end inside a character.
+	spanbelow: returns the length of the longest run of blocks of "s" whose
+		bytes are all below "limit", from 0x80 to 0xFF. The run may end inside
+		a character.
+	findpair: returns the length of the longest run of blocks of offsets "p"
+		of "s", from 0 to "n" - "gap" - 1 ("gap" below "n"), with no "p" where
+		"s[p]" is "a" and "s[p + gap]" is "b".
+	findsets: as findpair, with "s[p]" any of the 4 bytes of "a" and
+		"s[p + gap]" any of the 4 of "b".
+*/
+struct ENKERNELS {
+	enum ENISA isa;
+	unsigned int (*widenascii) (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be);
+	unsigned int (*narrowutf16) (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, unsigned int* w);
+	unsigned int (*widenutf8) (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, unsigned int* w);
+	unsigned int (*utf8countchars) (const BYTE* s, unsigned int n);
+	unsigned int (*utf8countutf16) (const BYTE* s, unsigned int n);
+	unsigned int (*utf16countutf8) (const BYTE* s, unsigned int n, BOOL be);
+	unsigned int (*ucs4countutf8) (const UCS4* s, unsigned int n);
+	unsigned int (*byteorder) (const BYTE* s, unsigned int n, BYTE* d, enum BYTEPERM p);
+	void (*zerocount) (const BYTE* s, unsigned int n, unsigned int* z);
+	unsigned int (*utf8valid) (const BYTE* s, unsigned int n);
+	unsigned int (*asciicopy) (const BYTE* s, unsigned int n, BYTE* d, unsigned int m);
+	unsigned int (*widensb) (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, enum ENCODING e);
+	unsigned int (*narrowsb) (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, enum ENCODING e);
+	unsigned int (*sbtoutf8) (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, enum ENCODING e, unsigned int* w);
+	unsigned int (*b64encode) (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, enum ENB64 a);
+	unsigned int (*b64decode) (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, enum ENB64 a);
+	unsigned int (*hexencode) (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL upper);
+	unsigned int (*hexdecode) (const BYTE* s, unsigned int n, BYTE* d, unsigned int m);
+	unsigned int (*lowerascii) (const BYTE* s, unsigned int n, BYTE* d, unsigned int m);
+	unsigned int (*foldascii) (const BYTE* a, const BYTE* b, unsigned int n);
+	unsigned int (*spanbelow) (const BYTE* s, unsigned int n, BYTE limit);
+	unsigned int (*findpair) (const BYTE* s, unsigned int n, BYTE a, BYTE b, unsigned int gap);
+	unsigned int (*findsets) (const BYTE* s, unsigned int n, const BYTE* a, const BYTE* b, unsigned int gap);
+};
+
+/*
+	Puts a UTF-16 code unit on "d" with the requested byte order.
+*/
+static inline void EN_PutUTF16 (BYTE* d, WORD w, BOOL be) {
+	if (be) {
+		d[0] = (BYTE) (w >> 8);
+		d[1] = (BYTE) w;
+	} else {
+		d[0] = (BYTE) w;
+		d[1] = (BYTE) (w >> 8);
+	}
+}
+
+/*
+	Tells if code point "c" is byte "c" in single byte charset "e": below 0x80
+	for ASCII, below 0x100 for Latin-1, and the same out of 0x80-0x9F for
+	Windows-1252.
+*/
+static inline BOOL EN_SBIdentity (enum ENCODING e, UCS4 c) {
+	switch (e) {
+		case ENC_ASCII:
+			return c < 0x80;
+		case ENC_CP1252:
+			return (c < 0x80) || ((c >= 0xA0) && (c <= 0xFF));
+		default:
+			return c <= 0xFF;
+	}
+}
+
+/*
+	Value of hex digit "c", or 0xFF if it isn't one.
+*/
+static inline BYTE EN_HexValue (BYTE c) {
+	if ((BYTE) (c - '0') <= 9)
+		return (BYTE) (c - '0');
+	c |= 0x20;
+	if ((BYTE) (c - 'a') <= 5)
+		return (BYTE) (c - 'a' + 10);
+
+	return 0xFF;
+}
+
+/*
+	Free bytes of output stream "s", after making room for "n" more if it grows.
+	May be less than "n".
+*/
+static inline unsigned int EN_StreamRoom (struct ENCSTREAM* s, unsigned long long n) {
+	if (s -> grow && (n <= 0xFFFFFFFFULL - s -> index))
+		EN_ReserveStream (s, (unsigned int) n);
+
+	return s -> size - s -> index;
+}
+
+const struct ENKERNELS* EN_GetKernels (void);
+
+// casefold.c
+// Bytes of a malformed sequence fold to this plus their value, past the last
+// code point.
+#define FOLD_MALFORMED 0x110000
+// Characters that fold to the same one, at most.
+#define FOLD_VARIANTS 4
+unsigned int EN_CaseVariants (UCS4 c, UCS4* v);
+
+/*
+	Returns the folding of the character at "*i" of "s" and moves "*i" past it.
+*/
+static inline UCS4 EN_FoldNext (const BYTE* s, unsigned int n, unsigned int* i) {
+	UCS4 c;
+	int by;
+
+	c = s[*i];
+	if (c < 0x80) {
+		(*i)++;
+		return (c >= 'A') && (c <= 'Z') ? c + 0x20 : c;
+	}
+	if ((by = EN_DecodeUTF8Seq (s + *i, n - *i, &c)) > 0) {
+		*i += by;
+		return EN_CaseFold (c);
+	}
+	(*i)++;
+
+	return FOLD_MALFORMED + s[*i - 1];
+}
+
+// transcode.c
+enum TRSTATUS EN_KUTF8ToUTF16 (const BYTE* s, unsigned int n, BYTE* d, unsigned int m,
+			BOOL be, BOOL replace, unsigned int* r, unsigned int* w);
+enum TRSTATUS EN_KUTF16ToUTF8 (const BYTE* s, unsigned int n, BYTE* d, unsigned int m,
+			BOOL be, BOOL replace, unsigned int* r, unsigned int* w);
+
+// kscalar.c
+extern const struct ENKERNELS EN_ScalarKernels;
+extern const char EN_B64Alphabet[2][65];
+extern const BYTE EN_B64Values[2][256];
+unsigned int EN_ScalarWidenUTF8 (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, unsigned int* w);
+unsigned int EN_ScalarUTF8CountChars (const BYTE* s, unsigned int n);
+unsigned int EN_ScalarUTF8CountUTF16 (const BYTE* s, unsigned int n);
+unsigned int EN_ScalarUTF16CountUTF8 (const BYTE* s, unsigned int n, BOOL be);
+unsigned int EN_ScalarUCS4CountUTF8 (const UCS4* s, unsigned int n);
+void EN_ScalarZeroCount (const BYTE* s, unsigned int n, unsigned int* z);
+unsigned int EN_ScalarUTF8Valid (const BYTE* s, unsigned int n);
+unsigned int EN_ScalarSBBlockToUTF8 (const BYTE* s, unsigned int n, BYTE* d);
+unsigned int EN_ScalarB64Encode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, enum ENB64 a);
+unsigned int EN_ScalarB64Decode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, enum ENB64 a);
+unsigned int EN_ScalarHexEncode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL upper);
+unsigned int EN_ScalarHexDecode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m);
+
+#ifdef EN_X86_KERNELS
+// ksse2.c, kavx2.c, kavx512.c
+extern const struct ENKERNELS EN_SSE2Kernels;
+extern const struct ENKERNELS EN_AVX2Kernels;
+extern const struct ENKERNELS EN_AVX512Kernels;
+unsigned int EN_AVX2NarrowUTF16 (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, unsigned int* w);
+unsigned int EN_AVX2WidenUTF8 (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, unsigned int* w);
+unsigned int EN_AVX2UTF16CountUTF8 (const BYTE* s, unsigned int n, BOOL be);
+unsigned int EN_AVX2UCS4CountUTF8 (const UCS4* s, unsigned int n);
+void EN_AVX2ZeroCount (const BYTE* s, unsigned int n, unsigned int* z);
+unsigned int EN_AVX2UTF8Valid (const BYTE* s, unsigned int n);
+unsigned int EN_AVX2NarrowSB (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, enum ENCODING e);
+unsigned int EN_AVX2SBToUTF8 (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, enum ENCODING e, unsigned int* w);
+unsigned int EN_AVX2B64Encode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, enum ENB64 a);
+unsigned int EN_AVX2B64Decode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, enum ENB64 a);
+unsigned int EN_AVX2HexEncode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL upper);
+unsigned int EN_AVX2HexDecode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m);
+unsigned int EN_AVX2LowerASCII (const BYTE* s, unsigned int n, BYTE* d, unsigned int m);
+unsigned int EN_AVX2FoldASCII (const BYTE* a, const BYTE* b, unsigned int n);
+#endif
+
+#endif
@@ -0,0 +1,528 @@
+/*
+	File: kscalar.c
+	Creation: 18-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Portable kernels. Used when the CPU has no supported vector extension and
+		for the tails of the vector kernels.
+*/
+
+#include <string.h>
+#include "kernels.h"
+
+#define ASCII_MASK 0x8080808080808080ULL
+
+/*
+	Widens ASCII blocks of 8 bytes. The test is done on a whole 64 bit word.
+*/
+static unsigned int EN_ScalarWidenASCII (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be) {
+	unsigned long long q;
+	unsigned int i, k;
+
+	for (i = 0; (n - i >= 8) && (m - 2 * i >= 16); i += 8) {
+		memcpy (&q, s + i, sizeof (q));
+		if (q & ASCII_MASK)
+			break;
+		for (k = 0; k < 8; k++)
+			EN_PutUTF16 (d + 2 * (i + k), s[i + k], be);
+	}
+
+	return i;
+}
+
+/*
+	Narrows ASCII blocks of 4 units.
+*/
+static unsigned int EN_ScalarNarrowUTF16 (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, unsigned int* w) {
+	unsigned long long q, mask;
+	unsigned int i, k;
+
+	// High byte of every unit must be zero and low byte must have no high bit.
+	// Where the high byte lands in "q" depends on both byte orders.
+#ifdef ARCH_BIG_ENDIAN
+	mask = be ? 0xFF80FF80FF80FF80ULL : 0x80FF80FF80FF80FFULL;
+#else
+	mask = be ? 0x80FF80FF80FF80FFULL : 0xFF80FF80FF80FF80ULL;
+#endif
+	for (i = 0; (n - i >= 8) && (m - i / 2 >= 4); i += 8) {
+		memcpy (&q, s + i, sizeof (q));
+		if (q & mask)
+			break;
+		for (k = 0; k < 4; k++)
+			d[i / 2 + k] = s[i + 2 * k + (be ? 1 : 0)];
+	}
+	*w = i / 2;
+
+	return i;
+}
+
+/*
+	Mixed UTF-8 blocks need byte shuffles, so the caller decodes them all.
+*/
+unsigned int EN_ScalarWidenUTF8 (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, unsigned int* w) {
+	(void) s;
+	(void) n;
+	(void) d;
+	(void) m;
+	(void) be;
+	*w = 0;
+
+	return 0;
+}
+
+unsigned int EN_ScalarUTF8CountChars (const BYTE* s, unsigned int n) {
+	unsigned int i, c;
+
+	for (i = c = 0; i < n; i++)
+		c += (s[i] & 0xC0) != 0x80;
+
+	return c;
+}
+
+unsigned int EN_ScalarUTF8CountUTF16 (const BYTE* s, unsigned int n) {
+	unsigned int i, c;
+
+	for (i = c = 0; i < n; i++)
+		c += ((s[i] & 0xC0) != 0x80) + ((s[i] & 0xF8) == 0xF0);
+
+	return c;
+}
+
+unsigned int EN_ScalarUTF16CountUTF8 (const BYTE* s, unsigned int n, BOOL be) {
+	unsigned int i, c;
+	WORD w;
+
+	for (i = c = 0; n - i >= 2; i += 2) {
+		w = EN_GetUTF16 (s + i, be);
+		c += 1 + (w >= 0x80) + (w >= 0x800) - ((w & 0xF800) == 0xD800);
+	}
+
+	return c;
+}
+
+unsigned int EN_ScalarUCS4CountUTF8 (const UCS4* s, unsigned int n) {
+	unsigned int i, c;
+
+	for (i = c = 0; i < n; i++)
+		c += 1 + (s[i] >= 0x00000080) + (s[i] >= 0x00000800) + (s[i] >= 0x00010000) +
+				(s[i] >= 0x00200000) + (s[i] >= 0x04000000);
+
+	return c;
+}
+
+/*
+	Permutes 4 byte blocks as native words. The permutations are their own
+	inverse, so the host byte order doesn't matter.
+*/
+static unsigned int EN_ScalarByteOrder (const BYTE* s, unsigned int n, BYTE* d, enum BYTEPERM p) {
+	unsigned int i, q;
+
+	for (i = 0; n - i >= 4; i += 4) {
+		memcpy (&q, s + i, sizeof (q));
+		switch (p) {
+			case PERM_SWAP16:
+				q = (q & 0x00FF00FF) << 8 | (q & 0xFF00FF00) >> 8;
+				break;
+			case PERM_SWAPHALVES:
+				q = q << 16 | q >> 16;
+				break;
+			case PERM_SWAP32:
+				q = (q & 0x00FF00FF) << 8 | (q & 0xFF00FF00) >> 8;
+				q = q << 16 | q >> 16;
+				break;
+		}
+		memcpy (d + i, &q, sizeof (q));
+	}
+
+	return i;
+}
+
+static unsigned int EN_ScalarASCIIPrefix (const BYTE* s, unsigned int n) {
+	unsigned long long q;
+	unsigned int i;
+
+	for (i = 0; n - i >= 8; i += 8) {
+		memcpy (&q, s + i, sizeof (q));
+		if (q & ASCII_MASK)
+			break;
+	}
+
+	return i;
+}
+
+/*
+	"s" is supposed to start at an offset multiple of 4.
+*/
+void EN_ScalarZeroCount (const BYTE* s, unsigned int n, unsigned int* z) {
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		z[i & 3] += s[i] == 0;
+}
+
+unsigned int EN_ScalarUTF8Valid (const BYTE* s, unsigned int n) {
+	unsigned int i;
+	int by;
+	UCS4 c;
+
+	i = 0;
+	while (i < n) {
+		i += EN_ScalarASCIIPrefix (s + i, n - i);
+		if (i == n)
+			break;
+		if (s[i] < 0x80) {
+			i++;
+			continue;
+		}
+		if ((by = EN_DecodeUTF8Seq (s + i, n - i, &c)) <= 0)
+			break;
+		i += by;
+	}
+
+	return i;
+}
+
+static unsigned int EN_ScalarASCIICopy (const BYTE* s, unsigned int n, BYTE* d, unsigned int m) {
+	unsigned long long q;
+	unsigned int i;
+
+	for (i = 0; (n - i >= 8) && (m - i >= 8); i += 8) {
+		memcpy (&q, s + i, sizeof (q));
+		if (q & ASCII_MASK)
+			break;
+		memcpy (d + i, &q, sizeof (q));
+	}
+
+	return i;
+}
+
+/*
+	Tells if a block of 8 bytes has any byte that isn't its own code point in
+	charset "e". Windows-1252 bytes 0x80-0x9F are found as zero bytes of the
+	block masked with 0xE0 and xored with 0x80.
+*/
+static inline BOOL EN_ScalarSBMapped (unsigned long long q, enum ENCODING e) {
+	switch (e) {
+		case ENC_ASCII:
+			return (q & ASCII_MASK) != 0;
+		case ENC_CP1252:
+			q = (q & 0xE0E0E0E0E0E0E0E0ULL) ^ ASCII_MASK;
+			return ((q - 0x0101010101010101ULL) & ~q & ASCII_MASK) != 0;
+		default:
+			return FALSE;
+	}
+}
+
+static unsigned int EN_ScalarWidenSB (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, enum ENCODING e) {
+	unsigned long long q;
+	unsigned int i, k;
+
+	for (i = 0; (n - i >= 8) && (m - 2 * i >= 16); i += 8) {
+		memcpy (&q, s + i, sizeof (q));
+		if (EN_ScalarSBMapped (q, e))
+			break;
+		for (k = 0; k < 8; k++)
+			EN_PutUTF16 (d + 2 * (i + k), s[i + k], be);
+	}
+
+	return i;
+}
+
+/*
+	Narrows blocks of 4 units.
+*/
+static unsigned int EN_ScalarNarrowSB (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, enum ENCODING e) {
+	unsigned int i, k;
+
+	for (i = 0; (n - i >= 8) && (m - i / 2 >= 4); i += 8) {
+		for (k = 0; k < 4; k++)
+			if (!EN_SBIdentity (e, EN_GetUTF16 (s + i + 2 * k, be)))
+				return i;
+		for (k = 0; k < 4; k++)
+			d[i / 2 + k] = s[i + 2 * k + (be ? 1 : 0)];
+	}
+
+	return i;
+}
+
+/*
+	Encodes "n" bytes that are their own code point as UTF-8 and returns the
+	bytes written, twice "n" at most.
+*/
+unsigned int EN_ScalarSBBlockToUTF8 (const BYTE* s, unsigned int n, BYTE* d) {
+	unsigned int i, j;
+
+	for (i = j = 0; i < n; i++)
+		if (s[i] < 0x80)
+			d[j++] = s[i];
+		else {
+			d[j] = (BYTE) (0xC0 | s[i] >> 6);
+			d[j + 1] = (BYTE) (0x80 | (s[i] & 0x3F));
+			j += 2;
+		}
+
+	return j;
+}
+
+static unsigned int EN_ScalarSBToUTF8 (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, enum ENCODING e, unsigned int* w) {
+	unsigned long long q;
+	unsigned int i, j;
+
+	for (i = j = 0; (n - i >= 8) && (m - j >= 16); i += 8) {
+		memcpy (&q, s + i, sizeof (q));
+		if (EN_ScalarSBMapped (q, e))
+			break;
+		if (q & ASCII_MASK)
+			j += EN_ScalarSBBlockToUTF8 (s + i, 8, d + j);
+		else {
+			memcpy (d + j, &q, sizeof (q));
+			j += 8;
+		}
+	}
+	*w = j;
+
+	return i;
+}
+
+/*
+	Base64 alphabets by enum ENB64, and the value of every character in them
+	(0xFF for the rest, '=' included).
+*/
+const char EN_B64Alphabet[2][65] = {
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/",
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"};
+
+const BYTE EN_B64Values[2][256] = {
+	{
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+		0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+		0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+		0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+	{
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF,
+		0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+		0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0x3F,
+		0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+		0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}};
+
+static const char HEXDIGITS[2][17] = {"0123456789abcdef", "0123456789ABCDEF"};
+
+unsigned int EN_ScalarB64Encode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, enum ENB64 a) {
+	const char* t;
+	unsigned int i, j;
+	UCS4 v;
+
+	t = EN_B64Alphabet[a];
+	for (i = j = 0; (n - i >= 3) && (m - j >= 4); i += 3, j += 4) {
+		v = (UCS4) s[i] << 16 | (UCS4) s[i + 1] << 8 | s[i + 2];
+		d[j] = (BYTE) t[v >> 18];
+		d[j + 1] = (BYTE) t[v >> 12 & 0x3F];
+		d[j + 2] = (BYTE) t[v >> 6 & 0x3F];
+		d[j + 3] = (BYTE) t[v & 0x3F];
+	}
+
+	return i;
+}
+
+unsigned int EN_ScalarB64Decode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, enum ENB64 a) {
+	const BYTE* t;
+	unsigned int i, j;
+	UCS4 v;
+
+	t = EN_B64Values[a];
+	for (i = j = 0; (n - i >= 4) && (m - j >= 3); i += 4, j += 3) {
+		// Invalid characters are the only values with the high bit set.
+		if ((t[s[i]] | t[s[i + 1]] | t[s[i + 2]] | t[s[i + 3]]) & 0x80)
+			break;
+		v = (UCS4) t[s[i]] << 18 | (UCS4) t[s[i + 1]] << 12 | (UCS4) t[s[i + 2]] << 6 | t[s[i + 3]];
+		d[j] = (BYTE) (v >> 16);
+		d[j + 1] = (BYTE) (v >> 8);
+		d[j + 2] = (BYTE) v;
+	}
+
+	return i;
+}
+
+unsigned int EN_ScalarHexEncode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL upper) {
+	const char* t;
+	unsigned int i;
+
+	t = HEXDIGITS[upper ? 1 : 0];
+	if (n > m / 2)
+		n = m / 2;
+	for (i = 0; i < n; i++) {
+		d[2 * i] = (BYTE) t[s[i] >> 4];
+		d[2 * i + 1] = (BYTE) t[s[i] & 0x0F];
+	}
+
+	return i;
+}
+
+unsigned int EN_ScalarHexDecode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m) {
+	unsigned int i;
+	BYTE hi, lo;
+
+	for (i = 0; (n - i >= 2) && (i / 2 < m); i += 2) {
+		hi = EN_HexValue (s[i]);
+		lo = EN_HexValue (s[i + 1]);
+		if ((hi | lo) & 0x80)
+			break;
+		d[i / 2] = (BYTE) (hi << 4 | lo);
+	}
+
+	return i;
+}
+
+/*
+	Makes 'A'-'Z' lowercase in a block of ASCII bytes: bytes from 'A' up get
+	the high bit set by an addition, and those above 'Z' by another one.
+*/
+static inline unsigned long long EN_ScalarLower (unsigned long long q) {
+	return q | (((q + 0x3F3F3F3F3F3F3F3FULL) ^ (q + 0x2525252525252525ULL)) & ASCII_MASK) >> 2;
+}
+
+static unsigned int EN_ScalarLowerASCII (const BYTE* s, unsigned int n, BYTE* d, unsigned int m) {
+	unsigned long long q;
+	unsigned int i;
+
+	for (i = 0; (n - i >= 8) && (m - i >= 8); i += 8) {
+		memcpy (&q, s + i, sizeof (q));
+		if (q & ASCII_MASK)
+			break;
+		q = EN_ScalarLower (q);
+		memcpy (d + i, &q, sizeof (q));
+	}
+
+	return i;
+}
+
+static unsigned int EN_ScalarFoldASCII (const BYTE* a, const BYTE* b, unsigned int n) {
+	unsigned long long p, q;
+	unsigned int i;
+
+	for (i = 0; n - i >= 8; i += 8) {
+		memcpy (&p, a + i, sizeof (p));
+		memcpy (&q, b + i, sizeof (q));
+		if ((p != q) && (((p | q) & ASCII_MASK) || (EN_ScalarLower (p) != EN_ScalarLower (q))))
+			break;
+	}
+
+	return i;
+}
+
+/*
+	A byte with its high bit set is below "limit" if its low 7 bits plus
+	0x100 - "limit" don't carry into the high bit.
+*/
+static unsigned int EN_ScalarSpanBelow (const BYTE* s, unsigned int n, BYTE limit) {
+	unsigned long long q, k;
+	unsigned int i;
+
+	k = (0x100 - limit) * 0x0101010101010101ULL;
+	for (i = 0; n - i >= 8; i += 8) {
+		memcpy (&q, s + i, sizeof (q));
+		if (q & ((q & ~ASCII_MASK) + k) & ASCII_MASK)
+			break;
+	}
+
+	return i;
+}
+
+/*
+	Sets the high bit of the zero bytes of "q", and of no other.
+*/
+static inline unsigned long long EN_ScalarZeroBytes (unsigned long long q) {
+	return ~(((q & ~ASCII_MASK) + ~ASCII_MASK) | q) & ASCII_MASK;
+}
+
+static unsigned int EN_ScalarFindPair (const BYTE* s, unsigned int n, BYTE a, BYTE b, unsigned int gap) {
+	unsigned long long p, q, ka, kb;
+	unsigned int i;
+
+	ka = a * 0x0101010101010101ULL;
+	kb = b * 0x0101010101010101ULL;
+	for (i = 0; n - gap - i >= 8; i += 8) {
+		memcpy (&p, s + i, sizeof (p));
+		memcpy (&q, s + i + gap, sizeof (q));
+		if (EN_ScalarZeroBytes (p ^ ka) & EN_ScalarZeroBytes (q ^ kb))
+			break;
+	}
+
+	return i;
+}
+
+/*
+	Sets the high bit of the bytes of "q" that are any of the 4 of "k".
+*/
+static inline unsigned long long EN_ScalarInSet (unsigned long long q, const unsigned long long* k) {
+	return EN_ScalarZeroBytes (q ^ k[0]) | EN_ScalarZeroBytes (q ^ k[1]) | EN_ScalarZeroBytes (q ^ k[2]) |
+			EN_ScalarZeroBytes (q ^ k[3]);
+}
+
+static unsigned int EN_ScalarFindSets (const BYTE* s, unsigned int n, const BYTE* a, const BYTE* b, unsigned int gap) {
+	unsigned long long p, q, ka[4], kb[4];
+	unsigned int i;
+
+	for (i = 0; i < 4; i++) {
+		ka[i] = a[i] * 0x0101010101010101ULL;
+		kb[i] = b[i] * 0x0101010101010101ULL;
+	}
+	for (i = 0; n - gap - i >= 8; i += 8) {
+		memcpy (&p, s + i, sizeof (p));
+		memcpy (&q, s + i + gap, sizeof (q));
+		if (EN_ScalarInSet (p, ka) & EN_ScalarInSet (q, kb))
+			break;
+	}
+
+	return i;
+}
+
+const struct ENKERNELS EN_ScalarKernels = {
+	ISA_SCALAR,
+	EN_ScalarWidenASCII,
+	EN_ScalarNarrowUTF16,
+	EN_ScalarWidenUTF8,
+	EN_ScalarUTF8CountChars,
+	EN_ScalarUTF8CountUTF16,
+	EN_ScalarUTF16CountUTF8,
+	EN_ScalarUCS4CountUTF8,
+	EN_ScalarByteOrder,
+	EN_ScalarZeroCount,
+	EN_ScalarUTF8Valid,
+	EN_ScalarASCIICopy,
+	EN_ScalarWidenSB,
+	EN_ScalarNarrowSB,
+	EN_ScalarSBToUTF8,
+	EN_ScalarB64Encode,
+	EN_ScalarB64Decode,
+	EN_ScalarHexEncode,
+	EN_ScalarHexDecode,
+	EN_ScalarLowerASCII,
+	EN_ScalarFoldASCII,
+	EN_ScalarSpanBelow,
+	EN_ScalarFindPair,
+	EN_ScalarFindSets};
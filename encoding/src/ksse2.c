@@ -0,0 +1,501 @@
+/*
+	File: ksse2.c
+	Creation: 18-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		SSE2 kernels (16 byte blocks).
+*/
+
+#include "kernels.h"
+
+#ifdef EN_X86_KERNELS
+
+#include <emmintrin.h>
+
+#define SSE2 __attribute__ ((target ("sse2")))
+
+/*
+	Swaps the bytes of every 16 bit lane.
+*/
+static inline SSE2 __m128i EN_SSE2Swap16 (__m128i v) {
+	return _mm_or_si128 (_mm_slli_epi16 (v, 8), _mm_srli_epi16 (v, 8));
+}
+
+/*
+	Adds the 16 byte counters of "acc".
+*/
+static inline SSE2 unsigned int EN_SSE2SumBytes (__m128i acc) {
+	__m128i t;
+
+	t = _mm_sad_epu8 (acc, _mm_setzero_si128 ());
+
+	return (unsigned int) _mm_cvtsi128_si32 (t) + (unsigned int) _mm_cvtsi128_si32 (_mm_srli_si128 (t, 8));
+}
+
+static SSE2 unsigned int EN_SSE2WidenASCII (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be) {
+	unsigned int i;
+	__m128i v, z;
+
+	z = _mm_setzero_si128 ();
+	for (i = 0; (n - i >= 16) && (m - 2 * i >= 32); i += 16) {
+		v = _mm_loadu_si128 ((const __m128i*) (s + i));
+		if (_mm_movemask_epi8 (v))
+			break;
+		if (be) {
+			_mm_storeu_si128 ((__m128i*) (d + 2 * i), _mm_unpacklo_epi8 (z, v));
+			_mm_storeu_si128 ((__m128i*) (d + 2 * i + 16), _mm_unpackhi_epi8 (z, v));
+		} else {
+			_mm_storeu_si128 ((__m128i*) (d + 2 * i), _mm_unpacklo_epi8 (v, z));
+			_mm_storeu_si128 ((__m128i*) (d + 2 * i + 16), _mm_unpackhi_epi8 (v, z));
+		}
+	}
+
+	return i;
+}
+
+static SSE2 unsigned int EN_SSE2NarrowUTF16 (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, unsigned int* w) {
+	unsigned int i, j;
+	__m128i v, t, z;
+
+	z = _mm_setzero_si128 ();
+	for (i = j = 0; n - i >= 16; i += 16) {
+		v = _mm_loadu_si128 ((const __m128i*) (s + i));
+		if (be)
+			v = EN_SSE2Swap16 (v);
+		// ASCII block: 8 units below 0x80 narrow to 8 bytes.
+		t = _mm_cmpeq_epi16 (_mm_and_si128 (v, _mm_set1_epi16 ((short) 0xFF80)), z);
+		if (_mm_movemask_epi8 (t) == 0xFFFF) {
+			if (m - j < 8)
+				break;
+			_mm_storel_epi64 ((__m128i*) (d + j), _mm_packus_epi16 (v, v));
+			j += 8;
+			continue;
+		}
+		// Two byte block: 8 units in [0x80, 0x7FF] become 8 lead/trail pairs.
+		if ((_mm_movemask_epi8 (t) != 0) ||
+				(_mm_movemask_epi8 (_mm_cmpeq_epi16 (_mm_and_si128 (v, _mm_set1_epi16 ((short) 0xF800)), z)) != 0xFFFF) ||
+				(m - j < 16))
+			break;
+		t = _mm_or_si128 (_mm_srli_epi16 (v, 6), _mm_set1_epi16 (0x00C0));
+		t = _mm_or_si128 (t, _mm_slli_epi16 (_mm_and_si128 (v, _mm_set1_epi16 (0x003F)), 8));
+		_mm_storeu_si128 ((__m128i*) (d + j), _mm_or_si128 (t, _mm_set1_epi16 ((short) 0x8000)));
+		j += 16;
+	}
+	*w = j;
+
+	return i;
+}
+
+/*
+	As signed bytes, continuation bytes (10xxxxxx) are the ones below -64.
+*/
+static SSE2 unsigned int EN_SSE2UTF8CountChars (const BYTE* s, unsigned int n) {
+	unsigned int i, c, k;
+	__m128i acc, v;
+
+	i = c = 0;
+	while (n - i >= 16) {
+		// Byte counters can take at most 255 blocks before they are summed.
+		acc = _mm_setzero_si128 ();
+		for (k = 0; (k < 255) && (n - i >= 16); k++, i += 16) {
+			v = _mm_loadu_si128 ((const __m128i*) (s + i));
+			acc = _mm_sub_epi8 (acc, _mm_cmpgt_epi8 (v, _mm_set1_epi8 (-65)));
+		}
+		c += EN_SSE2SumBytes (acc);
+	}
+
+	return c + EN_ScalarUTF8CountChars (s + i, n - i);
+}
+
+/*
+	Lead bytes 0xF0-0xF7 add the second unit of a surrogate pair.
+*/
+static SSE2 unsigned int EN_SSE2UTF8CountUTF16 (const BYTE* s, unsigned int n) {
+	unsigned int i, c, k;
+	__m128i acc, v, t;
+
+	i = c = 0;
+	while (n - i >= 16) {
+		acc = _mm_setzero_si128 ();
+		for (k = 0; (k < 127) && (n - i >= 16); k++, i += 16) {
+			v = _mm_loadu_si128 ((const __m128i*) (s + i));
+			acc = _mm_sub_epi8 (acc, _mm_cmpgt_epi8 (v, _mm_set1_epi8 (-65)));
+			t = _mm_cmpeq_epi8 (_mm_and_si128 (v, _mm_set1_epi8 ((char) 0xF8)), _mm_set1_epi8 ((char) 0xF0));
+			acc = _mm_sub_epi8 (acc, t);
+		}
+		c += EN_SSE2SumBytes (acc);
+	}
+
+	return c + EN_ScalarUTF8CountUTF16 (s + i, n - i);
+}
+
+/*
+	Counts 3 bytes per unit and substracts one for every unit below 0x800, one
+	more for every unit below 0x80 and one for every surrogate.
+*/
+static SSE2 unsigned int EN_SSE2UTF16CountUTF8 (const BYTE* s, unsigned int n, BOOL be) {
+	unsigned int i, c, k;
+	__m128i acc, v, z, t;
+
+	i = c = 0;
+	z = _mm_setzero_si128 ();
+	while (n - i >= 16) {
+		// Every lane goes down at most 2 per block, so flush before overflowing.
+		acc = _mm_setzero_si128 ();
+		for (k = 0; (k < 8192) && (n - i >= 16); k++, i += 16) {
+			v = _mm_loadu_si128 ((const __m128i*) (s + i));
+			if (be)
+				v = EN_SSE2Swap16 (v);
+			acc = _mm_add_epi16 (acc, _mm_cmpeq_epi16 (_mm_and_si128 (v, _mm_set1_epi16 ((short) 0xFF80)), z));
+			acc = _mm_add_epi16 (acc, _mm_cmpeq_epi16 (_mm_and_si128 (v, _mm_set1_epi16 ((short) 0xF800)), z));
+			t = _mm_cmpeq_epi16 (_mm_and_si128 (v, _mm_set1_epi16 ((short) 0xF800)), _mm_set1_epi16 ((short) 0xD800));
+			acc = _mm_add_epi16 (acc, t);
+		}
+		t = _mm_madd_epi16 (acc, _mm_set1_epi16 (-1));
+		t = _mm_add_epi32 (t, _mm_srli_si128 (t, 8));
+		t = _mm_add_epi32 (t, _mm_srli_si128 (t, 4));
+		c += 3 * (k * 8) - (unsigned int) _mm_cvtsi128_si32 (t);
+	}
+
+	return c + EN_ScalarUTF16CountUTF8 (s + i, n - i, be);
+}
+
+/*
+	Characters are not greater than 0x7FFFFFFF, so signed compares are enough.
+*/
+static SSE2 unsigned int EN_SSE2UCS4CountUTF8 (const UCS4* s, unsigned int n) {
+	unsigned int i;
+	__m128i acc, v;
+
+	acc = _mm_setzero_si128 ();
+	for (i = 0; n - i >= 4; i += 4) {
+		v = _mm_loadu_si128 ((const __m128i*) (s + i));
+		acc = _mm_sub_epi32 (acc, _mm_cmpgt_epi32 (v, _mm_set1_epi32 (0x0000007F)));
+		acc = _mm_sub_epi32 (acc, _mm_cmpgt_epi32 (v, _mm_set1_epi32 (0x000007FF)));
+		acc = _mm_sub_epi32 (acc, _mm_cmpgt_epi32 (v, _mm_set1_epi32 (0x0000FFFF)));
+		acc = _mm_sub_epi32 (acc, _mm_cmpgt_epi32 (v, _mm_set1_epi32 (0x001FFFFF)));
+		acc = _mm_sub_epi32 (acc, _mm_cmpgt_epi32 (v, _mm_set1_epi32 (0x03FFFFFF)));
+	}
+	acc = _mm_add_epi32 (acc, _mm_srli_si128 (acc, 8));
+	acc = _mm_add_epi32 (acc, _mm_srli_si128 (acc, 4));
+
+	return i + (unsigned int) _mm_cvtsi128_si32 (acc) + EN_ScalarUCS4CountUTF8 (s + i, n - i);
+}
+
+/*
+	SSE2 has no byte shuffle: 2 byte swaps are shifts and half swaps are 16 bit
+	lane shuffles.
+*/
+static SSE2 unsigned int EN_SSE2ByteOrder (const BYTE* s, unsigned int n, BYTE* d, enum BYTEPERM p) {
+	unsigned int i;
+	__m128i v;
+
+	for (i = 0; n - i >= 16; i += 16) {
+		v = _mm_loadu_si128 ((const __m128i*) (s + i));
+		if (p != PERM_SWAPHALVES)
+			v = EN_SSE2Swap16 (v);
+		if (p != PERM_SWAP16) {
+			v = _mm_shufflelo_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1));
+			v = _mm_shufflehi_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1));
+		}
+		_mm_storeu_si128 ((__m128i*) (d + i), v);
+	}
+
+	return i;
+}
+
+/*
+	Byte lanes count zeros for up to 255 blocks. Then the lanes at the same
+	offset modulo 4 are gathered from every 32 bit lane.
+*/
+static SSE2 void EN_SSE2ZeroCount (const BYTE* s, unsigned int n, unsigned int* z) {
+	unsigned int i, k, p;
+	__m128i acc, t, m;
+
+	i = 0;
+	m = _mm_set1_epi32 (0xFF);
+	while (n - i >= 16) {
+		acc = _mm_setzero_si128 ();
+		for (k = 0; (k < 255) && (n - i >= 16); k++, i += 16)
+			acc = _mm_sub_epi8 (acc, _mm_cmpeq_epi8 (_mm_loadu_si128 ((const __m128i*) (s + i)), _mm_setzero_si128 ()));
+		for (p = 0; p < 4; p++) {
+			t = _mm_and_si128 (_mm_srli_epi32 (acc, 8 * p), m);
+			t = _mm_add_epi32 (t, _mm_srli_si128 (t, 8));
+			t = _mm_add_epi32 (t, _mm_srli_si128 (t, 4));
+			z[p] += (unsigned int) _mm_cvtsi128_si32 (t);
+		}
+	}
+	EN_ScalarZeroCount (s + i, n - i, z);
+}
+
+static SSE2 unsigned int EN_SSE2ASCIICopy (const BYTE* s, unsigned int n, BYTE* d, unsigned int m) {
+	unsigned int i;
+	__m128i v;
+
+	for (i = 0; (n - i >= 16) && (m - i >= 16); i += 16) {
+		v = _mm_loadu_si128 ((const __m128i*) (s + i));
+		if (_mm_movemask_epi8 (v))
+			break;
+		_mm_storeu_si128 ((__m128i*) (d + i), v);
+	}
+
+	return i;
+}
+
+/*
+	Mask of the bytes of "v" that aren't their own code point in charset "e".
+*/
+static inline SSE2 int EN_SSE2SBMapped (__m128i v, enum ENCODING e) {
+	switch (e) {
+		case ENC_ASCII:
+			return _mm_movemask_epi8 (v);
+		case ENC_CP1252:
+			return _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_and_si128 (v, _mm_set1_epi8 ((char) 0xE0)),
+					_mm_set1_epi8 ((char) 0x80)));
+		default:
+			return 0;
+	}
+}
+
+static SSE2 unsigned int EN_SSE2WidenSB (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, enum ENCODING e) {
+	unsigned int i;
+	__m128i v, z;
+
+	z = _mm_setzero_si128 ();
+	for (i = 0; (n - i >= 16) && (m - 2 * i >= 32); i += 16) {
+		v = _mm_loadu_si128 ((const __m128i*) (s + i));
+		if (EN_SSE2SBMapped (v, e))
+			break;
+		if (be) {
+			_mm_storeu_si128 ((__m128i*) (d + 2 * i), _mm_unpacklo_epi8 (z, v));
+			_mm_storeu_si128 ((__m128i*) (d + 2 * i + 16), _mm_unpackhi_epi8 (z, v));
+		} else {
+			_mm_storeu_si128 ((__m128i*) (d + 2 * i), _mm_unpacklo_epi8 (v, z));
+			_mm_storeu_si128 ((__m128i*) (d + 2 * i + 16), _mm_unpackhi_epi8 (v, z));
+		}
+	}
+
+	return i;
+}
+
+/*
+	Units must be below 0x80 (ASCII) or 0x100, and out of 0x80-0x9F for
+	Windows-1252.
+*/
+static SSE2 unsigned int EN_SSE2NarrowSB (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL be, enum ENCODING e) {
+	unsigned int i;
+	__m128i v, hi, c1, z;
+
+	z = _mm_setzero_si128 ();
+	hi = _mm_set1_epi16 ((short) (e == ENC_ASCII ? 0xFF80 : 0xFF00));
+	c1 = _mm_set1_epi16 ((short) (e == ENC_CP1252 ? 0x0080 : 0xFFFF));
+	for (i = 0; (n - i >= 16) && (m - i / 2 >= 8); i += 16) {
+		v = _mm_loadu_si128 ((const __m128i*) (s + i));
+		if (be)
+			v = EN_SSE2Swap16 (v);
+		if ((_mm_movemask_epi8 (_mm_cmpeq_epi16 (_mm_and_si128 (v, hi), z)) != 0xFFFF) ||
+				_mm_movemask_epi8 (_mm_cmpeq_epi16 (_mm_and_si128 (v, _mm_set1_epi16 ((short) 0xFFE0)), c1)))
+			break;
+		_mm_storel_epi64 ((__m128i*) (d + i / 2), _mm_packus_epi16 (v, v));
+	}
+
+	return i;
+}
+
+/*
+	SSE2 can't pack bytes by a mask, so mixed blocks go through the scalar code.
+*/
+static SSE2 unsigned int EN_SSE2SBToUTF8 (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, enum ENCODING e, unsigned int* w) {
+	unsigned int i, j;
+	__m128i v;
+
+	for (i = j = 0; (n - i >= 16) && (m - j >= 32); i += 16) {
+		v = _mm_loadu_si128 ((const __m128i*) (s + i));
+		if (EN_SSE2SBMapped (v, e))
+			break;
+		if (_mm_movemask_epi8 (v))
+			j += EN_ScalarSBBlockToUTF8 (s + i, 16, d + j);
+		else {
+			_mm_storeu_si128 ((__m128i*) (d + j), v);
+			j += 16;
+		}
+	}
+	*w = j;
+
+	return i;
+}
+
+/*
+	Hex digits of nibbles "x": '0' plus the value, and "letters" more from 10.
+*/
+static inline SSE2 __m128i EN_SSE2HexDigits (__m128i x, __m128i letters) {
+	return _mm_add_epi8 (_mm_add_epi8 (x, _mm_set1_epi8 ('0')),
+			_mm_and_si128 (_mm_cmpgt_epi8 (x, _mm_set1_epi8 (9)), letters));
+}
+
+static SSE2 unsigned int EN_SSE2HexEncode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m, BOOL upper) {
+	__m128i v, hi, lo, letters;
+	unsigned int i;
+
+	letters = _mm_set1_epi8 (upper ? 'A' - '0' - 10 : 'a' - '0' - 10);
+	for (i = 0; (n - i >= 16) && (m - 2 * i >= 32); i += 16) {
+		v = _mm_loadu_si128 ((const __m128i*) (s + i));
+		hi = _mm_and_si128 (_mm_srli_epi16 (v, 4), _mm_set1_epi8 (0x0F));
+		lo = _mm_and_si128 (v, _mm_set1_epi8 (0x0F));
+		_mm_storeu_si128 ((__m128i*) (d + 2 * i), EN_SSE2HexDigits (_mm_unpacklo_epi8 (hi, lo), letters));
+		_mm_storeu_si128 ((__m128i*) (d + 2 * i + 16), EN_SSE2HexDigits (_mm_unpackhi_epi8 (hi, lo), letters));
+	}
+
+	return i + EN_ScalarHexEncode (s + i, n - i, d + 2 * i, m - 2 * i, upper);
+}
+
+/*
+	Decodes 16 hex digits of any case to 8 bytes. An unsigned comparison "x <= k"
+	is done as min (x, k) == x.
+*/
+static SSE2 unsigned int EN_SSE2HexDecode (const BYTE* s, unsigned int n, BYTE* d, unsigned int m) {
+	__m128i v, dg, isd, l, isl;
+	unsigned int i;
+
+	for (i = 0; (n - i >= 16) && (m - i / 2 >= 8); i += 16) {
+		v = _mm_loadu_si128 ((const __m128i*) (s + i));
+		dg = _mm_sub_epi8 (v, _mm_set1_epi8 ('0'));
+		isd = _mm_cmpeq_epi8 (_mm_min_epu8 (dg, _mm_set1_epi8 (9)), dg);
+		l = _mm_sub_epi8 (_mm_or_si128 (v, _mm_set1_epi8 (0x20)), _mm_set1_epi8 ('a'));
+		isl = _mm_cmpeq_epi8 (_mm_min_epu8 (l, _mm_set1_epi8 (5)), l);
+		if (_mm_movemask_epi8 (_mm_or_si128 (isd, isl)) != 0xFFFF)
+			break;
+		v = _mm_or_si128 (_mm_and_si128 (isd, dg), _mm_and_si128 (isl, _mm_add_epi8 (l, _mm_set1_epi8 (10))));
+		// First digit of every pair is the high nibble.
+		v = _mm_or_si128 (_mm_slli_epi16 (_mm_and_si128 (v, _mm_set1_epi16 (0x00FF)), 4), _mm_srli_epi16 (v, 8));
+		_mm_storel_epi64 ((__m128i*) (d + i / 2), _mm_packus_epi16 (v, v));
+	}
+
+	return i + EN_ScalarHexDecode (s + i, n - i, d + i / 2, m - i / 2);
+}
+
+/*
+	Makes 'A'-'Z' lowercase in a block of ASCII bytes.
+*/
+static inline SSE2 __m128i EN_SSE2Lower (__m128i v) {
+	__m128i upper;
+
+	upper = _mm_and_si128 (_mm_cmpgt_epi8 (v, _mm_set1_epi8 ('A' - 1)), _mm_cmplt_epi8 (v, _mm_set1_epi8 ('Z' + 1)));
+
+	return _mm_or_si128 (v, _mm_and_si128 (upper, _mm_set1_epi8 (0x20)));
+}
+
+static SSE2 unsigned int EN_SSE2LowerASCII (const BYTE* s, unsigned int n, BYTE* d, unsigned int m) {
+	unsigned int i;
+	__m128i v;
+
+	for (i = 0; (n - i >= 16) && (m - i >= 16); i += 16) {
+		v = _mm_loadu_si128 ((const __m128i*) (s + i));
+		if (_mm_movemask_epi8 (v))
+			break;
+		_mm_storeu_si128 ((__m128i*) (d + i), EN_SSE2Lower (v));
+	}
+
+	return i;
+}
+
+static SSE2 unsigned int EN_SSE2FoldASCII (const BYTE* a, const BYTE* b, unsigned int n) {
+	unsigned int i;
+	__m128i p, q;
+
+	for (i = 0; n - i >= 16; i += 16) {
+		p = _mm_loadu_si128 ((const __m128i*) (a + i));
+		q = _mm_loadu_si128 ((const __m128i*) (b + i));
+		if (_mm_movemask_epi8 (_mm_cmpeq_epi8 (p, q)) == 0xFFFF)
+			continue;
+		if (_mm_movemask_epi8 (_mm_or_si128 (p, q)) ||
+				(_mm_movemask_epi8 (_mm_cmpeq_epi8 (EN_SSE2Lower (p), EN_SSE2Lower (q))) != 0xFFFF))
+			break;
+	}
+
+	return i;
+}
+
+/*
+	A byte is below "limit" if it's the minimum of itself and "limit" - 1.
+*/
+static SSE2 unsigned int EN_SSE2SpanBelow (const BYTE* s, unsigned int n, BYTE limit) {
+	unsigned int i;
+	__m128i v, top;
+
+	top = _mm_set1_epi8 ((char) (limit - 1));
+	for (i = 0; n - i >= 16; i += 16) {
+		v = _mm_loadu_si128 ((const __m128i*) (s + i));
+		if (_mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_min_epu8 (v, top), v)) != 0xFFFF)
+			break;
+	}
+
+	return i;
+}
+
+static SSE2 unsigned int EN_SSE2FindPair (const BYTE* s, unsigned int n, BYTE a, BYTE b, unsigned int gap) {
+	unsigned int i;
+	__m128i va, vb;
+
+	va = _mm_set1_epi8 ((char) a);
+	vb = _mm_set1_epi8 ((char) b);
+	for (i = 0; n - gap - i >= 16; i += 16)
+		if (_mm_movemask_epi8 (_mm_and_si128 (_mm_cmpeq_epi8 (_mm_loadu_si128 ((const __m128i*) (s + i)), va),
+				_mm_cmpeq_epi8 (_mm_loadu_si128 ((const __m128i*) (s + i + gap)), vb))))
+			break;
+
+	return i;
+}
+
+/*
+	Sets the bytes of "v" that are any of the 4 of "k".
+*/
+static inline SSE2 __m128i EN_SSE2InSet (__m128i v, const __m128i* k) {
+	return _mm_or_si128 (_mm_or_si128 (_mm_cmpeq_epi8 (v, k[0]), _mm_cmpeq_epi8 (v, k[1])),
+			_mm_or_si128 (_mm_cmpeq_epi8 (v, k[2]), _mm_cmpeq_epi8 (v, k[3])));
+}
+
+static SSE2 unsigned int EN_SSE2FindSets (const BYTE* s, unsigned int n, const BYTE* a, const BYTE* b, unsigned int gap) {
+	unsigned int i;
+	__m128i ka[4], kb[4];
+
+	for (i = 0; i < 4; i++) {
+		ka[i] = _mm_set1_epi8 ((char) a[i]);
+		kb[i] = _mm_set1_epi8 ((char) b[i]);
+	}
+	for (i = 0; n - gap - i >= 16; i += 16)
+		if (_mm_movemask_epi8 (_mm_and_si128 (EN_SSE2InSet (_mm_loadu_si128 ((const __m128i*) (s + i)), ka),
+				EN_SSE2InSet (_mm_loadu_si128 ((const __m128i*) (s + i + gap)), kb))))
+			break;
+
+	return i;
+}
+
+const struct ENKERNELS EN_SSE2Kernels = {
+	ISA_SSE2,
+	EN_SSE2WidenASCII,
+	EN_SSE2NarrowUTF16,
+	EN_ScalarWidenUTF8,
+	EN_SSE2UTF8CountChars,
+	EN_SSE2UTF8CountUTF16,
+	EN_SSE2UTF16CountUTF8,
+	EN_SSE2UCS4CountUTF8,
+	EN_SSE2ByteOrder,
+	EN_SSE2ZeroCount,
+	EN_ScalarUTF8Valid,
+	EN_SSE2ASCIICopy,
+	EN_SSE2WidenSB,
+	EN_SSE2NarrowSB,
+	EN_SSE2SBToUTF8,
+	EN_ScalarB64Encode,
+	EN_ScalarB64Decode,
+	EN_SSE2HexEncode,
+	EN_SSE2HexDecode,
+	EN_SSE2LowerASCII,
+	EN_SSE2FoldASCII,
+	EN_SSE2SpanBelow,
+	EN_SSE2FindPair,
+	EN_SSE2FindSets};
+
+#endif
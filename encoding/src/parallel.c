@@ -0,0 +1,337 @@
+/*
+	File: parallel.c
+	Creation: 18-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Multi-threaded buffer transcoders for very large inputs. The input is
+		split at character boundaries into one chunk per thread, and it goes in
+		two passes:
+
+			1. Every thread counts the output bytes of its chunk.
+			2. A prefix sum of the counts gives every chunk its place on output,
+			   and every thread transcodes its chunk right there.
+
+		Output is the same as the one of the single threaded transcoders, and
+		errors are reported with offsets on the whole buffer.
+
+		The threads are kept in a pool that grows on demand and waits between
+		jobs, so a call doesn't pay for creating them. Jobs from several threads
+		take turns on it.
+*/
+
+#include <pthread.h>
+#include <unistd.h>
+#include "kernels.h"
+
+// Chunks smaller than this aren't worth a thread.
+#define PAR_MIN_CHUNK (1 << 20)
+// Upper limit to the thread count.
+#define PAR_MAX_THREADS 256
+
+/*
+	A chunk of input and its results. "count" is the output size of the chunk
+	as if it were valid, which is never less than the output of its valid prefix.
+*/
+struct PARCHUNK {
+	const BYTE* s;
+	unsigned int n;
+	unsigned long long count;
+	unsigned long long offset;
+	unsigned int r;
+	unsigned int w;
+	enum TRSTATUS st;
+};
+
+struct PARJOB {
+	struct PARCHUNK* chunks;
+	BYTE* d;
+	unsigned long long m;
+	BOOL utf8;
+	BOOL be;
+	unsigned int pass;
+};
+
+/*
+	A thread of the pool. Worker "k" runs chunk "k" of every pass, and "gen"
+	is the last pass it saw.
+*/
+struct PARWORKER {
+	unsigned int k;
+	unsigned long long gen;
+	pthread_t thread;
+};
+
+/*
+	Worker pool, started on first use and kept for the life of the process.
+	"PoolJob" lets one job at a time through, and its holder is the only one
+	that starts workers or passes. The rest is guarded by "PoolLock": every
+	pass bumps "PoolGen" and wakes the workers, and the last one of them to
+	finish its chunk signals "PoolDone".
+*/
+static pthread_mutex_t PoolJob = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t PoolLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t PoolGo = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t PoolDone = PTHREAD_COND_INITIALIZER;
+static struct PARWORKER PoolWorkers[PAR_MAX_THREADS];
+static unsigned int PoolSize = 0;
+static unsigned long long PoolGen = 0;
+static struct PARJOB* PoolCurrent = NULL;
+static unsigned int PoolChunks = 0;
+static unsigned int PoolPending = 0;
+
+/*
+	Runs the current pass of a job on chunk "k".
+*/
+static void EN_ParRun (struct PARJOB* job, unsigned int k) {
+	const struct ENKERNELS* kr;
+	struct PARCHUNK* c;
+	unsigned long long m;
+
+	kr = EN_GetKernels ();
+	c = &job -> chunks[k];
+	if (job -> pass == 0) {
+		if (job -> utf8)
+			c -> count = 2ULL * kr -> utf8countutf16 (c -> s, c -> n);
+		else
+			c -> count = kr -> utf16countutf8 (c -> s, c -> n & ~1U, job -> be);
+		return;
+	}
+	// Chunks that start past the end of output aren't converted at all.
+	if (c -> offset >= job -> m) {
+		c -> r = c -> w = 0;
+		c -> st = TR_DSTEND;
+		return;
+	}
+	m = job -> m - c -> offset;
+	if (m > c -> count)
+		m = c -> count;
+	c -> st = (job -> utf8 ? EN_KUTF8ToUTF16 : EN_KUTF16ToUTF8) (c -> s, c -> n,
+			job -> d + c -> offset, (unsigned int) m, job -> be, FALSE, &c -> r, &c -> w);
+}
+
+static void* EN_ParThread (void* p) {
+	struct PARWORKER* w;
+	struct PARJOB* job;
+
+	w = (struct PARWORKER*) p;
+	pthread_mutex_lock (&PoolLock);
+	for (;;) {
+		while (w -> gen == PoolGen)
+			pthread_cond_wait (&PoolGo, &PoolLock);
+		w -> gen = PoolGen;
+		if (w -> k >= PoolChunks)
+			continue;
+		job = PoolCurrent;
+		pthread_mutex_unlock (&PoolLock);
+		EN_ParRun (job, w -> k);
+		pthread_mutex_lock (&PoolLock);
+		if (--PoolPending == 0)
+			pthread_cond_signal (&PoolDone);
+	}
+
+	return NULL;
+}
+
+/*
+	Grows the pool up to "n" workers, less if threads can't be created. Called
+	with "PoolJob" held.
+*/
+static void EN_ParStart (unsigned int n) {
+	struct PARWORKER* w;
+
+	while (PoolSize < n) {
+		w = &PoolWorkers[PoolSize + 1];
+		w -> k = PoolSize + 1;
+		w -> gen = PoolGen;
+		if (pthread_create (&w -> thread, NULL, EN_ParThread, w) != 0)
+			break;
+		pthread_detach (w -> thread);
+		PoolSize++;
+	}
+}
+
+/*
+	Runs the current pass of a job on "t" chunks and waits for all of them,
+	so a pass ends in a barrier. Chunk 0 is run on the calling thread, and so
+	are the chunks the pool has no worker for. Called with "PoolJob" held.
+*/
+static void EN_ParPass (struct PARJOB* job, unsigned int t) {
+	unsigned int k, n;
+
+	n = t - 1 < PoolSize ? t - 1 : PoolSize;
+	pthread_mutex_lock (&PoolLock);
+	PoolCurrent = job;
+	PoolChunks = t;
+	PoolPending = n;
+	PoolGen++;
+	pthread_cond_broadcast (&PoolGo);
+	pthread_mutex_unlock (&PoolLock);
+	EN_ParRun (job, 0);
+	for (k = n + 1; k < t; k++)
+		EN_ParRun (job, k);
+	pthread_mutex_lock (&PoolLock);
+	while (PoolPending != 0)
+		pthread_cond_wait (&PoolDone, &PoolLock);
+	pthread_mutex_unlock (&PoolLock);
+}
+
+/*
+	Returns the start of the character at or after "i". UTF-8 skips
+	continuation bytes, UTF-16 skips a low surrogate so pairs stay together.
+*/
+static unsigned int EN_ParBoundary (const BYTE* s, unsigned int n, unsigned int i, BOOL utf8, BOOL be) {
+	unsigned int k;
+	WORD w;
+
+	if (utf8) {
+		for (k = 0; (k < 3) && (i < n) && ((s[i] & 0xC0) == 0x80); k++)
+			i++;
+		return i;
+	}
+	i &= ~1U;
+	if (n - i >= 2) {
+		w = EN_GetUTF16 (s + i, be);
+		if ((w >= 0xDC00) && (w <= 0xDFFF))
+			i += 2;
+	}
+
+	return i;
+}
+
+/*
+	Returns how many processors are online, 1 where it can't be told.
+*/
+static unsigned int EN_ParProcessors (void) {
+#ifdef _SC_NPROCESSORS_ONLN
+	long cpus;
+
+	cpus = sysconf (_SC_NPROCESSORS_ONLN);
+
+	return cpus > 0 ? (unsigned int) cpus : 1;
+#else
+	return 1;
+#endif
+}
+
+/*
+	Splits the unread part of "in" into chunks and runs both passes on them.
+*/
+static BOOL EN_ParTranscode (struct ENCSTREAM* in, struct ENCSTREAM* out, unsigned int threads, BOOL utf8, BOOL be) {
+	struct PARCHUNK chunks[PAR_MAX_THREADS];
+	struct PARJOB job;
+	const BYTE* s;
+	unsigned int n, t, k, i, e;
+	unsigned long long sum;
+
+	s = in -> buffer + in -> index;
+	n = in -> size - in -> index;
+	if (threads == 0)
+		threads = EN_ParProcessors ();
+	t = n / PAR_MIN_CHUNK;
+	if (t > threads)
+		t = threads;
+	if (t > PAR_MAX_THREADS)
+		t = PAR_MAX_THREADS;
+	if (t < 2) {
+		if (utf8)
+			return be ? EN_UTF8ToUTF16Be (in, out) : EN_UTF8ToUTF16Le (in, out);
+		return be ? EN_UTF16BeToUTF8 (in, out) : EN_UTF16LeToUTF8 (in, out);
+	}
+	// Chunk bounds. A boundary may move up to a few bytes, so a chunk may be empty.
+	for (k = i = 0; k < t; k++) {
+		e = k == t - 1 ? n : EN_ParBoundary (s, n, (unsigned int) ((unsigned long long) n * (k + 1) / t), utf8, be);
+		if (e < i)
+			e = i;
+		chunks[k].s = s + i;
+		chunks[k].n = e - i;
+		i = e;
+	}
+	job.chunks = chunks;
+	job.utf8 = utf8;
+	job.be = be;
+	job.pass = 0;
+	pthread_mutex_lock (&PoolJob);
+	EN_ParStart (t - 1);
+	EN_ParPass (&job, t);
+	for (k = 0, sum = 0; k < t; k++) {
+		chunks[k].offset = sum;
+		sum += chunks[k].count;
+	}
+	// A growing output takes all the room at once. Failing that, the chunks
+	// that don't fit stop as on a fixed one.
+	if (out -> grow && (sum <= 0xFFFFFFFFULL - out -> index))
+		EN_ReserveStream (out, (unsigned int) sum);
+	job.d = out -> buffer + out -> index;
+	job.m = out -> size - out -> index;
+	job.pass = 1;
+	EN_ParPass (&job, t);
+	pthread_mutex_unlock (&PoolJob);
+	// The first chunk that didn't end well decides. Output of the chunks after
+	// it is left beyond "out -> index".
+	for (k = 0; k < t; k++) {
+		if (chunks[k].st == TR_OK)
+			continue;
+		in -> index += (unsigned int) (chunks[k].s - s) + chunks[k].r;
+		out -> index += (unsigned int) chunks[k].offset + chunks[k].w;
+		switch (chunks[k].st) {
+			case TR_SRCEND:
+				// Only the last chunk can be cut by the end of input. Others
+				// are cut by the next chunk, which starts a new character.
+				if (k == t - 1)
+					in -> eob = TRUE;
+				return FALSE;
+			case TR_DSTEND:
+				out -> eob = TRUE;
+				return FALSE;
+			default:
+				return FALSE;
+		}
+	}
+	in -> index += n;
+	out -> index += (unsigned int) sum;
+
+	return TRUE;
+}
+
+/*
+	Multi-threaded EN_UTF8ToUTF16Le(). Same results, with every offset on the
+	whole buffer. Output past "out -> index" is undefined when it fails.
+
+	[Params]
+
+		in: UTF-8 input.
+		out: UTF-16 output.
+		threads: thread count, or 0 for one per online processor (just one
+			where the system can't tell how many are). Inputs under
+			1 MB per thread use less threads, down to the single threaded path.
+
+	[Return]
+
+		Same as EN_UTF8ToUTF16Le().
+*/
+BOOL EN_UTF8ToUTF16LeParallel (struct ENCSTREAM* in, struct ENCSTREAM* out, unsigned int threads) {
+	return EN_ParTranscode (in, out, threads, TRUE, FALSE);
+}
+
+/*
+	Idem to EN_UTF8ToUTF16LeParallel().
+*/
+BOOL EN_UTF8ToUTF16BeParallel (struct ENCSTREAM* in, struct ENCSTREAM* out, unsigned int threads) {
+	return EN_ParTranscode (in, out, threads, TRUE, TRUE);
+}
+
+/*
+	Multi-threaded EN_UTF16LeToUTF8(). Same parameters as
+	EN_UTF8ToUTF16LeParallel().
+*/
+BOOL EN_UTF16LeToUTF8Parallel (struct ENCSTREAM* in, struct ENCSTREAM* out, unsigned int threads) {
+	return EN_ParTranscode (in, out, threads, FALSE, FALSE);
+}
+
+/*
+	Idem to EN_UTF16LeToUTF8Parallel().
+*/
+BOOL EN_UTF16BeToUTF8Parallel (struct ENCSTREAM* in, struct ENCSTREAM* out, unsigned int threads) {
+	return EN_ParTranscode (in, out, threads, FALSE, TRUE);
+}
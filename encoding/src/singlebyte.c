@@ -0,0 +1,480 @@
+/*
+	File: singlebyte.c
+	Creation: 19-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Single byte charsets: ISO-8859-1 (Latin-1), Windows-1252 and US-ASCII.
+		Per character reading and writing, and buffer transcoders to and from
+		UTF-8 and UTF-16.
+
+		Most bytes of these charsets are their own code point, so the kernels
+		move whole blocks of them: blocks of bytes that stand for themselves
+		are encoded to UTF-8 or widened to UTF-16, UTF-16 blocks of such units
+		are narrowed, and ASCII blocks are copied as they are from UTF-8. The
+		rest goes one character at a time through the Windows-1252 table.
+
+		Referencies:
+
+			https://encoding.spec.whatwg.org/index-windows-1252.txt
+*/
+
+#include "kernels.h"
+
+// Bytes handled one character at a time after a vector block kernel stops,
+// before trying it again.
+#define SCALAR_RUN 32
+
+// Windows-1252 code points by byte. Bytes 0x81, 0x8D, 0x8F, 0x90 and 0x9D,
+// unused by the charset, are the C1 controls of the same value (WHATWG).
+static const WORD CP1252[256] = {
+	0x0000, 0x0001, 0x0002, 0x0003, 0x0004, 0x0005, 0x0006, 0x0007,
+	0x0008, 0x0009, 0x000A, 0x000B, 0x000C, 0x000D, 0x000E, 0x000F,
+	0x0010, 0x0011, 0x0012, 0x0013, 0x0014, 0x0015, 0x0016, 0x0017,
+	0x0018, 0x0019, 0x001A, 0x001B, 0x001C, 0x001D, 0x001E, 0x001F,
+	0x0020, 0x0021, 0x0022, 0x0023, 0x0024, 0x0025, 0x0026, 0x0027,
+	0x0028, 0x0029, 0x002A, 0x002B, 0x002C, 0x002D, 0x002E, 0x002F,
+	0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037,
+	0x0038, 0x0039, 0x003A, 0x003B, 0x003C, 0x003D, 0x003E, 0x003F,
+	0x0040, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047,
+	0x0048, 0x0049, 0x004A, 0x004B, 0x004C, 0x004D, 0x004E, 0x004F,
+	0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057,
+	0x0058, 0x0059, 0x005A, 0x005B, 0x005C, 0x005D, 0x005E, 0x005F,
+	0x0060, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067,
+	0x0068, 0x0069, 0x006A, 0x006B, 0x006C, 0x006D, 0x006E, 0x006F,
+	0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077,
+	0x0078, 0x0079, 0x007A, 0x007B, 0x007C, 0x007D, 0x007E, 0x007F,
+	0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+	0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+	0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+	0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178,
+	0x00A0, 0x00A1, 0x00A2, 0x00A3, 0x00A4, 0x00A5, 0x00A6, 0x00A7,
+	0x00A8, 0x00A9, 0x00AA, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x00AF,
+	0x00B0, 0x00B1, 0x00B2, 0x00B3, 0x00B4, 0x00B5, 0x00B6, 0x00B7,
+	0x00B8, 0x00B9, 0x00BA, 0x00BB, 0x00BC, 0x00BD, 0x00BE, 0x00BF,
+	0x00C0, 0x00C1, 0x00C2, 0x00C3, 0x00C4, 0x00C5, 0x00C6, 0x00C7,
+	0x00C8, 0x00C9, 0x00CA, 0x00CB, 0x00CC, 0x00CD, 0x00CE, 0x00CF,
+	0x00D0, 0x00D1, 0x00D2, 0x00D3, 0x00D4, 0x00D5, 0x00D6, 0x00D7,
+	0x00D8, 0x00D9, 0x00DA, 0x00DB, 0x00DC, 0x00DD, 0x00DE, 0x00DF,
+	0x00E0, 0x00E1, 0x00E2, 0x00E3, 0x00E4, 0x00E5, 0x00E6, 0x00E7,
+	0x00E8, 0x00E9, 0x00EA, 0x00EB, 0x00EC, 0x00ED, 0x00EE, 0x00EF,
+	0x00F0, 0x00F1, 0x00F2, 0x00F3, 0x00F4, 0x00F5, 0x00F6, 0x00F7,
+	0x00F8, 0x00F9, 0x00FA, 0x00FB, 0x00FC, 0x00FD, 0x00FE, 0x00FF};
+
+typedef enum TRSTATUS (*SBKERNEL) (enum ENCODING enc, const BYTE* s, unsigned int n, BYTE* d, unsigned int m,
+			BOOL be, unsigned int* r, unsigned int* w);
+
+/*
+	Decodes byte "b" of charset "enc". Returns FALSE for bytes ASCII lacks.
+*/
+static inline BOOL EN_SBDecode (enum ENCODING enc, BYTE b, UCS4* c) {
+	if (enc == ENC_CP1252) {
+		*c = CP1252[b];
+		return TRUE;
+	}
+	*c = b;
+
+	return (enc != ENC_ASCII) || (b < 0x80);
+}
+
+/*
+	Encodes character "c" into charset "enc". Returns FALSE if it lacks it.
+*/
+static inline BOOL EN_SBEncode (enum ENCODING enc, UCS4 c, BYTE* b) {
+	unsigned int k;
+
+	if (EN_SBIdentity (enc, c)) {
+		*b = (BYTE) c;
+		return TRUE;
+	}
+	if (enc == ENC_CP1252)
+		for (k = 0x80; k < 0xA0; k++)
+			if (CP1252[k] == c) {
+				*b = (BYTE) k;
+				return TRUE;
+			}
+
+	return FALSE;
+}
+
+/*
+	Single byte to UTF-8 kernel. "r" and "w" return how many bytes were read
+	and written, as in the kernels of transcode.c.
+*/
+static enum TRSTATUS EN_KSBToUTF8 (enum ENCODING enc, const BYTE* s, unsigned int n, BYTE* d, unsigned int m,
+			BOOL be, unsigned int* r, unsigned int* w) {
+	const struct ENKERNELS* k;
+	unsigned int i, j, e, t, by;
+	enum TRSTATUS st;
+	UCS4 c;
+
+	(void) be;
+	k = EN_GetKernels ();
+	i = j = 0;
+	st = TR_OK;
+	while (i < n) {
+		e = k -> sbtoutf8 (s + i, n - i, d + j, m - j, enc, &t);
+		i += e;
+		j += t;
+		e = n - i > SCALAR_RUN ? i + SCALAR_RUN : n;
+		for (; i < e; i++) {
+			if (!EN_SBDecode (enc, s[i], &c)) {
+				st = TR_INVALID;
+				goto end;
+			}
+			// Windows-1252 has characters up to U+2122, 3 bytes at most.
+			by = 1 + (c >= 0x80) + (c >= 0x800);
+			if (m - j < by) {
+				st = TR_DSTEND;
+				goto end;
+			}
+			switch (by) {
+				case 1:
+					d[j] = (BYTE) c;
+					break;
+				case 2:
+					d[j] = (BYTE) (0xC0 | c >> 6);
+					d[j + 1] = (BYTE) (0x80 | (c & 0x3F));
+					break;
+				default:
+					d[j] = (BYTE) (0xE0 | c >> 12);
+					d[j + 1] = (BYTE) (0x80 | (c >> 6 & 0x3F));
+					d[j + 2] = (BYTE) (0x80 | (c & 0x3F));
+			}
+			j += by;
+		}
+	}
+
+end:
+	*r = i;
+	*w = j;
+
+	return st;
+}
+
+static enum TRSTATUS EN_KSBToUTF16 (enum ENCODING enc, const BYTE* s, unsigned int n, BYTE* d, unsigned int m,
+			BOOL be, unsigned int* r, unsigned int* w) {
+	const struct ENKERNELS* k;
+	unsigned int i, j, e;
+	enum TRSTATUS st;
+	UCS4 c;
+
+	k = EN_GetKernels ();
+	i = j = 0;
+	st = TR_OK;
+	while (i < n) {
+		e = k -> widensb (s + i, n - i, d + j, m - j, be, enc);
+		i += e;
+		j += 2 * e;
+		e = n - i > SCALAR_RUN ? i + SCALAR_RUN : n;
+		for (; i < e; i++) {
+			if (!EN_SBDecode (enc, s[i], &c)) {
+				st = TR_INVALID;
+				goto end;
+			}
+			if (m - j < 2) {
+				st = TR_DSTEND;
+				goto end;
+			}
+			EN_PutUTF16 (d + j, (WORD) c, be);
+			j += 2;
+		}
+	}
+
+end:
+	*r = i;
+	*w = j;
+
+	return st;
+}
+
+/*
+	UTF-8 (RFC 3629) to single byte kernel. Characters the charset lacks are
+	reported as malformed input.
+*/
+static enum TRSTATUS EN_KUTF8ToSB (enum ENCODING enc, const BYTE* s, unsigned int n, BYTE* d, unsigned int m,
+			BOOL be, unsigned int* r, unsigned int* w) {
+	const struct ENKERNELS* k;
+	unsigned int i, j, e;
+	enum TRSTATUS st;
+	int by;
+	UCS4 c;
+
+	(void) be;
+	k = EN_GetKernels ();
+	i = j = 0;
+	st = TR_OK;
+	while (i < n) {
+		e = k -> asciicopy (s + i, n - i, d + j, m - j);
+		i += e;
+		j += e;
+		e = n - i > SCALAR_RUN ? i + SCALAR_RUN : n;
+		while (i < e) {
+			if (m - j < 1) {
+				st = TR_DSTEND;
+				goto end;
+			}
+			if (s[i] < 0x80) {
+				d[j++] = s[i++];
+				continue;
+			}
+			if ((by = EN_DecodeUTF8Seq (s + i, n - i, &c)) <= 0) {
+				st = by == 0 ? TR_INVALID : TR_SRCEND;
+				goto end;
+			}
+			if (!EN_SBEncode (enc, c, d + j)) {
+				st = TR_INVALID;
+				goto end;
+			}
+			i += by;
+			j++;
+		}
+	}
+
+end:
+	*r = i;
+	*w = j;
+
+	return st;
+}
+
+/*
+	UTF-16 to single byte kernel. As EN_KUTF8ToSB(), characters the charset
+	lacks are malformed input, surrogate pairs included.
+*/
+static enum TRSTATUS EN_KUTF16ToSB (enum ENCODING enc, const BYTE* s, unsigned int n, BYTE* d, unsigned int m,
+			BOOL be, unsigned int* r, unsigned int* w) {
+	const struct ENKERNELS* k;
+	unsigned int i, j, e;
+	enum TRSTATUS st;
+	WORD w1;
+
+	k = EN_GetKernels ();
+	i = j = 0;
+	st = TR_OK;
+	while (n - i >= 2) {
+		e = k -> narrowsb (s + i, n - i, d + j, m - j, be, enc);
+		i += e;
+		j += e / 2;
+		e = n - i > SCALAR_RUN ? i + SCALAR_RUN : n;
+		for (; (i < e) && (n - i >= 2); i += 2) {
+			w1 = EN_GetUTF16 (s + i, be);
+			// A high surrogate whose pair may still come is incomplete input.
+			if ((w1 >= 0xD800) && (w1 <= 0xDBFF) && (n - i < 4)) {
+				st = TR_SRCEND;
+				goto end;
+			}
+			if ((w1 >= 0xD800) && (w1 <= 0xDFFF)) {
+				st = TR_INVALID;
+				goto end;
+			}
+			if (m - j < 1) {
+				st = TR_DSTEND;
+				goto end;
+			}
+			if (!EN_SBEncode (enc, w1, d + j)) {
+				st = TR_INVALID;
+				goto end;
+			}
+			j++;
+		}
+	}
+	// An odd trailing byte is half a unit.
+	if (i < n)
+		st = TR_SRCEND;
+
+end:
+	*r = i;
+	*w = j;
+
+	return st;
+}
+
+/*
+	Runs a kernel over the unread part of "in" and the free part of "out" and
+	updates both streams, as EN_Transcode() does in transcode.c.
+*/
+static BOOL EN_SBTranscode (enum ENCODING enc, struct ENCSTREAM* in, struct ENCSTREAM* out, BOOL be, SBKERNEL kernel) {
+	unsigned int r, w;
+	enum TRSTATUS st;
+
+	if ((enc < ENC_LATIN1) || (enc > ENC_ASCII))
+		return FALSE;
+	do {
+		st = kernel (enc, in -> buffer + in -> index, in -> size - in -> index,
+				out -> buffer + out -> index, out -> size - out -> index, be, &r, &w);
+		in -> index += r;
+		out -> index += w;
+	} while ((st == TR_DSTEND) && out -> grow && EN_ReserveStream (out, 4));
+	switch (st) {
+		case TR_SRCEND:
+			in -> eob = TRUE;
+			return FALSE;
+		case TR_DSTEND:
+			out -> eob = TRUE;
+			return FALSE;
+		case TR_INVALID:
+			return FALSE;
+		default:
+			return TRUE;
+	}
+}
+
+/*
+	Reads a character of charset "enc" from "s".
+*/
+static BOOL EN_ReadSB (struct ENCSTREAM* s, enum ENCODING enc, UCS4* c) {
+	if (s -> index >= s -> size) {
+		s -> eob = TRUE;
+		return FALSE;
+	}
+	if (!EN_SBDecode (enc, s -> buffer[s -> index], c))
+		return FALSE;
+	s -> index++;
+
+	return TRUE;
+}
+
+/*
+	Writes character "c" to "s" in charset "enc".
+*/
+static BOOL EN_WriteSB (UCS4 c, struct ENCSTREAM* s, enum ENCODING enc) {
+	BYTE b;
+
+	if (!EN_SBEncode (enc, c, &b))
+		return FALSE;
+	if ((s -> size - s -> index < 1) && !EN_ReserveStream (s, 1)) {
+		s -> eob = TRUE;
+		return FALSE;
+	}
+	s -> buffer[s -> index++] = b;
+
+	return TRUE;
+}
+
+/*
+	Reads a Latin-1 character.
+
+	[Params]
+
+		s: input stream. "index" advances over the byte read.
+		c: the character.
+
+	[Return]
+
+		"TRUE" if a character was read. "FALSE" at the end of the stream, with
+		"s -> eob" set. EN_ReadASCII() also fails on bytes above 0x7F, with
+		"s -> index" left on them.
+*/
+BOOL EN_ReadLatin1 (struct ENCSTREAM* s, UCS4* c) {
+	return EN_ReadSB (s, ENC_LATIN1, c);
+}
+
+/*
+	Idem to EN_ReadLatin1().
+*/
+BOOL EN_ReadCP1252 (struct ENCSTREAM* s, UCS4* c) {
+	return EN_ReadSB (s, ENC_CP1252, c);
+}
+
+/*
+	Idem to EN_ReadLatin1().
+*/
+BOOL EN_ReadASCII (struct ENCSTREAM* s, UCS4* c) {
+	return EN_ReadSB (s, ENC_ASCII, c);
+}
+
+/*
+	Writes a character as Latin-1.
+
+	[Params]
+
+		c: the character.
+		s: output stream. "index" advances over the byte written.
+
+	[Return]
+
+		"TRUE" if it was written. "FALSE" if the charset lacks "c", or if there
+		is no space left on "s", with "s -> eob" set.
+*/
+BOOL EN_UCS4ToLatin1 (UCS4 c, struct ENCSTREAM* s) {
+	return EN_WriteSB (c, s, ENC_LATIN1);
+}
+
+/*
+	Idem to EN_UCS4ToLatin1().
+*/
+BOOL EN_UCS4ToCP1252 (UCS4 c, struct ENCSTREAM* s) {
+	return EN_WriteSB (c, s, ENC_CP1252);
+}
+
+/*
+	Idem to EN_UCS4ToLatin1().
+*/
+BOOL EN_UCS4ToASCII (UCS4 c, struct ENCSTREAM* s) {
+	return EN_WriteSB (c, s, ENC_ASCII);
+}
+
+/*
+	Transcodes the unread part of a single byte stream into a UTF-8 stream.
+
+	[Params]
+
+		encoding: charset of "in": ENC_LATIN1, ENC_CP1252 or ENC_ASCII.
+		in: input. "index" advances over the converted bytes.
+		out: UTF-8 output. "index" advances over the written bytes.
+
+	[Return]
+
+		Same as EN_UTF8ToUTF16Le(). Only ASCII input can be malformed (bytes above
+		0x7F). "FALSE" for other encodings, with nothing converted.
+*/
+BOOL EN_SingleByteToUTF8 (enum ENCODING encoding, struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	return EN_SBTranscode (encoding, in, out, FALSE, EN_KSBToUTF8);
+}
+
+/*
+	Idem to EN_SingleByteToUTF8(), into UTF-16.
+*/
+BOOL EN_SingleByteToUTF16Le (enum ENCODING encoding, struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	return EN_SBTranscode (encoding, in, out, FALSE, EN_KSBToUTF16);
+}
+
+/*
+	Idem to EN_SingleByteToUTF16Le().
+*/
+BOOL EN_SingleByteToUTF16Be (enum ENCODING encoding, struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	return EN_SBTranscode (encoding, in, out, TRUE, EN_KSBToUTF16);
+}
+
+/*
+	Transcodes the unread part of a UTF-8 stream into a single byte stream.
+
+	[Params]
+
+		encoding: charset of "out": ENC_LATIN1, ENC_CP1252 or ENC_ASCII.
+		in: UTF-8 input. "index" advances over the converted bytes.
+		out: output. "index" advances over the written bytes.
+
+	[Return]
+
+		Same as EN_UTF8ToUTF16Le(). A character the charset lacks stops it as
+		malformed input, with "in -> index" on it.
+*/
+BOOL EN_UTF8ToSingleByte (enum ENCODING encoding, struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	return EN_SBTranscode (encoding, in, out, FALSE, EN_KUTF8ToSB);
+}
+
+/*
+	Idem to EN_UTF8ToSingleByte(), from UTF-16.
+*/
+BOOL EN_UTF16LeToSingleByte (enum ENCODING encoding, struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	return EN_SBTranscode (encoding, in, out, FALSE, EN_KUTF16ToSB);
+}
+
+/*
+	Idem to EN_UTF16LeToSingleByte().
+*/
+BOOL EN_UTF16BeToSingleByte (enum ENCODING encoding, struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	return EN_SBTranscode (encoding, in, out, TRUE, EN_KUTF16ToSB);
+}
@@ -0,0 +1,365 @@
+/*
+	File: transcode.c
+	Creation: 18-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Buffer to buffer transcoding between UTF-8 and UTF-16 without going
+		through an intermediate UCS-4 character per call. Vector work is done by
+		the kernels bound in dispatch.c.
+
+		UTF-8 handling follows RFC 3629 (code points up to 0x10FFFF, no surrogates,
+		no overlong forms) because every accepted character must be representable
+		in UTF-16.
+
+		Referencies:
+
+			http://www.faqs.org/rfcs/rfc3629.html
+			http://www.faqs.org/rfcs/rfc2781.html
+*/
+
+#include <string.h>
+#include "kernels.h"
+
+// Bytes handled one character at a time after a vector block kernel stops,
+// before trying it again.
+#define SCALAR_RUN 32
+
+/*
+	UTF-8 to UTF-16 kernel. "r" and "w" return how many bytes were read and written.
+	With "replace" malformed sequences become U+FFFD instead of stopping it.
+*/
+enum TRSTATUS EN_KUTF8ToUTF16 (const BYTE* s, unsigned int n, BYTE* d, unsigned int m,
+			BOOL be, BOOL replace, unsigned int* r, unsigned int* w) {
+	const struct ENKERNELS* k;
+	unsigned int i, j, e, t;
+	int by;
+	UCS4 c;
+
+	k = EN_GetKernels ();
+	i = j = 0;
+	while (i < n) {
+		// ASCII fast path and blocks of up to 3 byte characters, then at least
+		// SCALAR_RUN bytes one character at a time before trying the vector
+		// path again.
+		e = k -> widenascii (s + i, n - i, d + j, m - j, be);
+		i += e;
+		j += 2 * e;
+		e = k -> widenutf8 (s + i, n - i, d + j, m - j, be, &t);
+		i += e;
+		j += t;
+		e = n - i > SCALAR_RUN ? i + SCALAR_RUN : n;
+		while (i < e) {
+			if (s[i] < 0x80) {
+				if (m - j < 2)
+					goto dstend;
+				EN_PutUTF16 (d + j, s[i], be);
+				i++;
+				j += 2;
+				continue;
+			}
+			if (((by = EN_DecodeUTF8Seq (s + i, n - i, &c)) == 0) && replace) {
+				if (m - j < 2)
+					goto dstend;
+				EN_PutUTF16 (d + j, 0xFFFD, be);
+				i += EN_UTF8Subpart (s + i, n - i);
+				j += 2;
+				continue;
+			}
+			if (by <= 0) {
+				*r = i;
+				*w = j;
+				return by == 0 ? TR_INVALID : TR_SRCEND;
+			}
+			// BMP characters are a single unit, the rest a surrogate pair.
+			if (c < 0x00010000) {
+				if (m - j < 2)
+					goto dstend;
+				EN_PutUTF16 (d + j, (WORD) c, be);
+				j += 2;
+			} else {
+				if (m - j < 4)
+					goto dstend;
+				c -= 0x00010000;
+				EN_PutUTF16 (d + j, (WORD) (0xD800 | c >> 10), be);
+				EN_PutUTF16 (d + j + 2, (WORD) (0xDC00 | (c & 0x03FF)), be);
+				j += 4;
+			}
+			i += by;
+		}
+	}
+	*r = i;
+	*w = j;
+
+	return TR_OK;
+
+dstend:
+	*r = i;
+	*w = j;
+
+	return TR_DSTEND;
+}
+
+/*
+	UTF-16 to UTF-8 kernel. "r" and "w" return how many bytes were read and written.
+	With "replace" every unpaired surrogate becomes U+FFFD instead of stopping it.
+*/
+enum TRSTATUS EN_KUTF16ToUTF8 (const BYTE* s, unsigned int n, BYTE* d, unsigned int m,
+			BOOL be, BOOL replace, unsigned int* r, unsigned int* w) {
+	const struct ENKERNELS* k;
+	unsigned int i, j, e, t;
+	WORD w1, w2;
+	UCS4 c;
+
+	k = EN_GetKernels ();
+	i = j = 0;
+	while (n - i >= 2) {
+		// Blocks with no surrogates, then at least SCALAR_RUN bytes one unit at
+		// a time before trying the vector path again.
+		e = k -> narrowutf16 (s + i, n - i, d + j, m - j, be, &t);
+		i += e;
+		j += t;
+		e = n - i > SCALAR_RUN ? i + SCALAR_RUN : n;
+		while ((i < e) && (n - i >= 2)) {
+			w1 = EN_GetUTF16 (s + i, be);
+			// BMP: everything but surrogates maps to 1, 2 or 3 bytes.
+			if (w1 < 0x80) {
+				if (m - j < 1)
+					goto dstend;
+				d[j++] = (BYTE) w1;
+				i += 2;
+				continue;
+			}
+			if (w1 < 0x800) {
+				if (m - j < 2)
+					goto dstend;
+				d[j] = (BYTE) (0xC0 | w1 >> 6);
+				d[j + 1] = (BYTE) (0x80 | (w1 & 0x3F));
+				i += 2;
+				j += 2;
+				continue;
+			}
+			if ((w1 < 0xD800) || (w1 > 0xDFFF)) {
+				if (m - j < 3)
+					goto dstend;
+				d[j] = (BYTE) (0xE0 | w1 >> 12);
+				d[j + 1] = (BYTE) (0x80 | (w1 >> 6 & 0x3F));
+				d[j + 2] = (BYTE) (0x80 | (w1 & 0x3F));
+				i += 2;
+				j += 3;
+				continue;
+			}
+			// A low surrogate can't start a pair.
+			if (w1 > 0xDBFF)
+				goto unpaired;
+			if (n - i < 4)
+				goto srcend;
+			w2 = EN_GetUTF16 (s + i + 2, be);
+			if ((w2 < 0xDC00) || (w2 > 0xDFFF))
+				goto unpaired;
+			if (m - j < 4)
+				goto dstend;
+			c = ((UCS4) (w1 & 0x03FF) << 10 | (UCS4) (w2 & 0x03FF)) + 0x00010000;
+			d[j] = (BYTE) (0xF0 | c >> 18);
+			d[j + 1] = (BYTE) (0x80 | (c >> 12 & 0x3F));
+			d[j + 2] = (BYTE) (0x80 | (c >> 6 & 0x3F));
+			d[j + 3] = (BYTE) (0x80 | (c & 0x3F));
+			i += 4;
+			j += 4;
+			continue;
+
+		unpaired:
+			if (!replace)
+				goto invalid;
+			// U+FFFD, and the unit after the surrogate is read again.
+			if (m - j < 3)
+				goto dstend;
+			d[j] = 0xEF;
+			d[j + 1] = 0xBF;
+			d[j + 2] = 0xBD;
+			i += 2;
+			j += 3;
+		}
+	}
+	*r = i;
+	*w = j;
+
+	// An odd trailing byte is half a unit.
+	return i < n ? TR_SRCEND : TR_OK;
+
+invalid:
+	*r = i;
+	*w = j;
+
+	return TR_INVALID;
+
+srcend:
+	*r = i;
+	*w = j;
+
+	return TR_SRCEND;
+
+dstend:
+	*r = i;
+	*w = j;
+
+	return TR_DSTEND;
+}
+
+/*
+	Runs a kernel over the unread part of "in" and the free part of "out" and
+	updates both streams. A growing "out" is enlarged every time it gets full.
+*/
+static BOOL EN_Transcode (struct ENCSTREAM* in, struct ENCSTREAM* out, BOOL be, BOOL replace,
+			enum TRSTATUS (*kernel) (const BYTE*, unsigned int, BYTE*, unsigned int, BOOL, BOOL, unsigned int*, unsigned int*)) {
+	unsigned int r, w;
+	enum TRSTATUS st;
+
+	do {
+		st = kernel (in -> buffer + in -> index, in -> size - in -> index,
+				out -> buffer + out -> index, out -> size - out -> index, be, replace, &r, &w);
+		in -> index += r;
+		out -> index += w;
+		// No character takes more than 4 bytes on output.
+	} while ((st == TR_DSTEND) && out -> grow && EN_ReserveStream (out, 4));
+	switch (st) {
+		case TR_SRCEND:
+			in -> eob = TRUE;
+			return FALSE;
+		case TR_DSTEND:
+			out -> eob = TRUE;
+			return FALSE;
+		case TR_INVALID:
+			return FALSE;
+		default:
+			return TRUE;
+	}
+}
+
+/*
+	Transcodes the unread part of a UTF-8 stream into a UTF-16 stream.
+
+	[Params]
+
+		in: UTF-8 input. "index" advances over the converted bytes.
+		out: UTF-16 output. "index" advances over the written bytes.
+
+	[Return]
+
+		"TRUE" if all the input was converted, "FALSE" in other case. If the input
+		is malformed "in -> index" points to the erroneous sequence. If the input
+		ends in the middle of a sequence "in -> eob" is set, and if there is no
+		space left on output "out -> eob" is set. In both cases the conversion can
+		be resumed from the current indexes.
+*/
+BOOL EN_UTF8ToUTF16Le (struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	return EN_Transcode (in, out, FALSE, FALSE, EN_KUTF8ToUTF16);
+}
+
+/*
+	Idem to EN_UTF8ToUTF16Le().
+*/
+BOOL EN_UTF8ToUTF16Be (struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	return EN_Transcode (in, out, TRUE, FALSE, EN_KUTF8ToUTF16);
+}
+
+/*
+	Transcodes the unread part of a UTF-16 stream into a UTF-8 stream. Same
+	return semantics as EN_UTF8ToUTF16Le(). An unpaired surrogate is an error.
+*/
+BOOL EN_UTF16LeToUTF8 (struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	return EN_Transcode (in, out, FALSE, FALSE, EN_KUTF16ToUTF8);
+}
+
+/*
+	Idem to EN_UTF16LeToUTF8().
+*/
+BOOL EN_UTF16BeToUTF8 (struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	return EN_Transcode (in, out, TRUE, FALSE, EN_KUTF16ToUTF8);
+}
+
+/*
+	Lossy EN_UTF8ToUTF16Le(). Every maximal subpart of a malformed sequence is
+	replaced by U+FFFD (WHATWG "replacement" error mode) and the conversion goes
+	on, without leaving the vector path for long.
+
+	[Return]
+
+		"TRUE" if all the input was converted. "FALSE" only if the input ends in
+		the middle of a sequence ("in -> eob"), which can still be completed by
+		more input, or if there is no space left on output ("out -> eob"). At the
+		real end of input such a sequence stands for one more U+FFFD.
+*/
+BOOL EN_UTF8ToUTF16LeLossy (struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	return EN_Transcode (in, out, FALSE, TRUE, EN_KUTF8ToUTF16);
+}
+
+/*
+	Idem to EN_UTF8ToUTF16LeLossy().
+*/
+BOOL EN_UTF8ToUTF16BeLossy (struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	return EN_Transcode (in, out, TRUE, TRUE, EN_KUTF8ToUTF16);
+}
+
+/*
+	Lossy EN_UTF16LeToUTF8(). Every unpaired surrogate is replaced by U+FFFD.
+	Same return semantics as EN_UTF8ToUTF16LeLossy().
+*/
+BOOL EN_UTF16LeToUTF8Lossy (struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	return EN_Transcode (in, out, FALSE, TRUE, EN_KUTF16ToUTF8);
+}
+
+/*
+	Idem to EN_UTF16LeToUTF8Lossy().
+*/
+BOOL EN_UTF16BeToUTF8Lossy (struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	return EN_Transcode (in, out, TRUE, TRUE, EN_KUTF16ToUTF8);
+}
+
+
+/*
+	Counts the characters of a UTF-8 buffer, that is, the bytes that are not
+	continuation bytes (10xxxxxx). The buffer is supposed to be valid UTF-8.
+
+	[Params]
+
+		s: UTF-8 bytes.
+		n: byte count.
+
+	[Return]
+
+		Number of characters.
+*/
+unsigned int EN_UTF8CountChars (const BYTE* s, unsigned int n) {
+	return EN_GetKernels () -> utf8countchars (s, n);
+}
+
+/*
+	Counts the UTF-16 units needed to hold a UTF-8 buffer. Every character is one
+	unit but the 4 byte ones (lead byte 11110xxx), which need a surrogate pair.
+	The buffer is supposed to be valid UTF-8.
+*/
+unsigned int EN_UTF8CountUTF16 (const BYTE* s, unsigned int n) {
+	return EN_GetKernels () -> utf8countutf16 (s, n);
+}
+
+/*
+	Counts the UTF-8 bytes needed to hold a UTF-16 buffer of "n" bytes. Units
+	below 0x80 take 1 byte, below 0x800 2 bytes, every surrogate 2 bytes (4 the
+	pair) and the rest 3 bytes.
+*/
+unsigned int EN_UTF16LeCountUTF8 (const BYTE* s, unsigned int n) {
+	return EN_GetKernels () -> utf16countutf8 (s, n, FALSE);
+}
+
+unsigned int EN_UTF16BeCountUTF8 (const BYTE* s, unsigned int n) {
+	return EN_GetKernels () -> utf16countutf8 (s, n, TRUE);
+}
+
+/*
+	Counts the UTF-8 bytes needed to hold "n" UCS-4 characters with the same
+	ranges as EN_UCS4ToUTF8(). Characters must not be greater than 0x7FFFFFFF.
+*/
+unsigned int EN_UCS4CountUTF8 (const UCS4* s, unsigned int n) {
+	return EN_GetKernels () -> ucs4countutf8 (s, n);
+}
@@ -0,0 +1,853 @@
+/*
+	File: transfile.c
+	Creation: 19-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		File to file transcoding that overlaps reading, transcoding and writing.
+		The file goes through FILE_SLOTS slots of FILE_CHUNK bytes, every one
+		with an output buffer large enough for its chunk in any encoding, so
+		memory is bounded whatever the file size: while a chunk is transcoded
+		the next one is being read and the one before written.
+
+		On Linux reads and writes are submitted to an io_uring by the calling
+		thread, which transcodes while they run. Where there's no io_uring
+		(other systems, older kernels, system call filters) a reader and a
+		writer thread do blocking I/O around it.
+
+		Chunks go through the buffer transcoders where there's one for the
+		pair of encodings, and one character at a time otherwise. A sequence
+		cut by the end of a chunk is carried over to the start of the next.
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "enccodec.h"
+#include "kernels.h"
+
+#if defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#ifdef __NR_io_uring_setup
+#define EN_FILE_URING
+#endif
+#endif
+
+// Input bytes by slot.
+#define FILE_CHUNK (1 << 20)
+// Slots: one being read, one transcoded and one written.
+#define FILE_SLOTS 3
+// Bytes before every chunk for the tail of a sequence cut by the one before.
+#define FILE_CARRY 8
+// Output bytes by input byte, at most (ASCII to UCS-4).
+#define FILE_GROWTH 4
+// Output buffer of a slot.
+#define FILE_OUTSIZE (FILE_GROWTH * (FILE_CARRY + FILE_CHUNK))
+
+// What a slot is doing.
+// FS_FREE: nothing, its output was written.
+// FS_READING: a read into it is in progress.
+// FS_READ: its chunk is there to be transcoded.
+// FS_CONVERTED: its output is there to be written.
+// FS_WRITING: a write from it is in progress.
+enum FILESTATE {FS_FREE, FS_READING, FS_READ, FS_CONVERTED, FS_WRITING};
+
+typedef BOOL (*FILEREADFN) (struct ENCSTREAM*, UCS4*);
+typedef BOOL (*FILEWRITEFN) (UCS4, struct ENCSTREAM*);
+
+/*
+	A chunk and its output. "in" has FILE_CARRY bytes before the chunk, "nin"
+	of them read, and "done" counts the bytes of "out" written. "seq" is the
+	chunk number and "offset" its place on the file being read or written.
+	"last" marks the last chunk: the end of the file, or where it failed.
+*/
+struct FILESLOT {
+	BYTE* in;
+	BYTE* out;
+	unsigned int nin;
+	unsigned int nout;
+	unsigned int done;
+	unsigned long long seq;
+	unsigned long long offset;
+	enum FILESTATE state;
+	BOOL last;
+};
+
+/*
+	A transcoding. Files that can't take reads or writes at any offset
+	("inseek", "outseek") are read and written one request at a time, at
+	their own position. "error" is the errno of the first I/O error, and
+	"bad" is set by malformed input.
+*/
+struct FILEJOB {
+	int infd;
+	int outfd;
+	enum ENCODING inenc;
+	enum ENCODING outenc;
+	BOOL inseek;
+	BOOL outseek;
+	unsigned long long inoff;
+	unsigned long long outoff;
+	struct FILESLOT slots[FILE_SLOTS];
+	BYTE carry[FILE_CARRY];
+	unsigned int ncarry;
+	int error;
+	BOOL bad;
+	BOOL stop;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+};
+
+/*
+	Encoders with no function of their own in encoding.c.
+*/
+static BOOL EN_FileUTF16Le (UCS4 c, struct ENCSTREAM* s) {
+	return EN_EncodeUTF16 (c, s, FALSE);
+}
+
+static BOOL EN_FileUTF16Be (UCS4 c, struct ENCSTREAM* s) {
+	return EN_EncodeUTF16 (c, s, TRUE);
+}
+
+static BOOL EN_FileUCS4Le (UCS4 c, struct ENCSTREAM* s) {
+	return EN_EncodeUCS4 (c, s, ENC_UCS4LE);
+}
+
+static BOOL EN_FileUCS4Be (UCS4 c, struct ENCSTREAM* s) {
+	return EN_EncodeUCS4 (c, s, ENC_UCS4BE);
+}
+
+static BOOL EN_FileUCS4Uoo3412 (UCS4 c, struct ENCSTREAM* s) {
+	return EN_EncodeUCS4 (c, s, ENC_UCS4UOO3412);
+}
+
+static BOOL EN_FileUCS4Uoo2143 (UCS4 c, struct ENCSTREAM* s) {
+	return EN_EncodeUCS4 (c, s, ENC_UCS4UOO2143);
+}
+
+/*
+	Per character decoders and encoders, indexed by enum ENCODING.
+*/
+static const FILEREADFN FILEREADERS[] = {
+	NULL,
+	EN_UTF8ToUCS4,
+	EN_UTF16LeToUCS4,
+	EN_UTF16BeToUCS4,
+	EN_ReadUCS4Le,
+	EN_ReadUCS4Be,
+	EN_ReadUCS4Uoo3412,
+	EN_ReadUCS4Uoo2143,
+	EN_ReadLatin1,
+	EN_ReadCP1252,
+	EN_ReadASCII};
+
+static const FILEWRITEFN FILEWRITERS[] = {
+	NULL,
+	EN_UCS4ToUTF8,
+	EN_FileUTF16Le,
+	EN_FileUTF16Be,
+	EN_FileUCS4Le,
+	EN_FileUCS4Be,
+	EN_FileUCS4Uoo3412,
+	EN_FileUCS4Uoo2143,
+	EN_UCS4ToLatin1,
+	EN_UCS4ToCP1252,
+	EN_UCS4ToASCII};
+
+/*
+	Transcodes "in" onto "out", as the buffer transcoders do: FALSE with
+	"in -> eob" set if it ends inside a sequence, FALSE alone if it's malformed
+	or has a character "oe" lacks. Same encodings are copied as they are.
+*/
+static BOOL EN_FileConvert (enum ENCODING ie, enum ENCODING oe, struct ENCSTREAM* in, struct ENCSTREAM* out) {
+	UCS4 c;
+
+	if (ie == oe) {
+		memcpy (out -> buffer + out -> index, in -> buffer + in -> index, in -> size - in -> index);
+		out -> index += in -> size - in -> index;
+		in -> index = in -> size;
+		return TRUE;
+	}
+	if (ie == ENC_UTF8) {
+		if (oe == ENC_UTF16LE)
+			return EN_UTF8ToUTF16Le (in, out);
+		if (oe == ENC_UTF16BE)
+			return EN_UTF8ToUTF16Be (in, out);
+		if (oe >= ENC_LATIN1)
+			return EN_UTF8ToSingleByte (oe, in, out);
+	}
+	if ((ie == ENC_UTF16LE) || (ie == ENC_UTF16BE)) {
+		if (oe == ENC_UTF8)
+			return ie == ENC_UTF16LE ? EN_UTF16LeToUTF8 (in, out) : EN_UTF16BeToUTF8 (in, out);
+		if (oe >= ENC_LATIN1)
+			return ie == ENC_UTF16LE ? EN_UTF16LeToSingleByte (oe, in, out) : EN_UTF16BeToSingleByte (oe, in, out);
+	}
+	if (ie >= ENC_LATIN1) {
+		if (oe == ENC_UTF8)
+			return EN_SingleByteToUTF8 (ie, in, out);
+		if (oe == ENC_UTF16LE)
+			return EN_SingleByteToUTF16Le (ie, in, out);
+		if (oe == ENC_UTF16BE)
+			return EN_SingleByteToUTF16Be (ie, in, out);
+	}
+	// The decoders leave "index" at the start of a cut sequence.
+	while (in -> index < in -> size) {
+		if (!FILEREADERS[ie] (in, &c))
+			return FALSE;
+		if (!FILEWRITERS[oe] (c, out))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+/*
+	Transcodes the chunk of slot "t", after the bytes carried from the one
+	before, and keeps the tail of a sequence it cuts. Malformed input, or a
+	sequence cut by the end of the file, sets "job -> bad" and makes "t" the
+	last slot, with the output before it.
+*/
+static void EN_FileConvertSlot (struct FILEJOB* job, struct FILESLOT* t) {
+	struct ENCSTREAM in, out;
+	BOOL ok;
+
+	memcpy (t -> in + FILE_CARRY - job -> ncarry, job -> carry, job -> ncarry);
+	EN_InitStream (&in, t -> in + FILE_CARRY - job -> ncarry, job -> ncarry + t -> nin);
+	EN_InitStream (&out, t -> out, FILE_OUTSIZE);
+	ok = EN_FileConvert (job -> inenc, job -> outenc, &in, &out);
+	t -> nout = out.index;
+	t -> done = 0;
+	job -> ncarry = in.size - in.index;
+	if (!ok && (!in.eob || t -> last || (job -> ncarry > FILE_CARRY))) {
+		job -> bad = TRUE;
+		t -> last = TRUE;
+		return;
+	}
+	memcpy (job -> carry, in.buffer + in.index, job -> ncarry);
+}
+
+/*
+	Tells if "fd" is a regular file, so it takes reads and writes at any
+	offset, and gets its position on "offset". With "append" a file opened
+	with O_APPEND isn't, since it can only be written at its end. Systems
+	without F_GETFL (Windows) can't tell, and none is taken as such.
+*/
+static BOOL EN_FileSeekable (int fd, BOOL append, unsigned long long* offset) {
+	struct stat st;
+	off_t p;
+#ifdef F_GETFL
+	int fl;
+#endif
+
+	*offset = 0;
+	if ((fstat (fd, &st) != 0) || !S_ISREG (st.st_mode))
+		return FALSE;
+#ifdef F_GETFL
+	if (append && ((fl = fcntl (fd, F_GETFL)) != -1) && (fl & O_APPEND))
+		return FALSE;
+#else
+	(void) append;
+#endif
+	if ((p = lseek (fd, 0, SEEK_CUR)) < 0)
+		return FALSE;
+	*offset = (unsigned long long) p;
+
+	return TRUE;
+}
+
+/*
+	Reads on "d" until "n" bytes are there or the file ends, and returns how
+	many are. -1 on error.
+*/
+static long EN_FileReadAll (int fd, BYTE* d, unsigned int n) {
+	unsigned int i;
+	ssize_t r;
+
+	for (i = 0; i < n; i += (unsigned int) r)
+		if ((r = read (fd, d + i, n - i)) == 0)
+			break;
+		else if (r < 0) {
+			if (errno == EINTR)
+				r = 0;
+			else
+				return -1;
+		}
+
+	return (long) i;
+}
+
+/*
+	Writes the "n" bytes of "s". FALSE on error.
+*/
+static BOOL EN_FileWriteAll (int fd, const BYTE* s, unsigned int n) {
+	unsigned int i;
+	ssize_t r;
+
+	for (i = 0; i < n; i += (unsigned int) r)
+		if ((r = write (fd, s + i, n - i)) < 0) {
+			if (errno != EINTR)
+				return FALSE;
+			r = 0;
+		}
+
+	return TRUE;
+}
+
+/*
+	Thread driver: reads every chunk on its slot, in order.
+*/
+static void* EN_FileReader (void* p) {
+	struct FILEJOB* job;
+	struct FILESLOT* t;
+	unsigned long long q;
+	long n;
+
+	job = (struct FILEJOB*) p;
+	for (q = 0; ; q++) {
+		t = &job -> slots[q % FILE_SLOTS];
+		pthread_mutex_lock (&job -> lock);
+		while ((t -> state != FS_FREE) && !job -> stop)
+			pthread_cond_wait (&job -> cond, &job -> lock);
+		if (job -> stop) {
+			pthread_mutex_unlock (&job -> lock);
+			break;
+		}
+		pthread_mutex_unlock (&job -> lock);
+		n = EN_FileReadAll (job -> infd, t -> in + FILE_CARRY, FILE_CHUNK);
+		pthread_mutex_lock (&job -> lock);
+		if (n < 0) {
+			job -> error = errno;
+			job -> stop = TRUE;
+		} else {
+			t -> nin = (unsigned int) n;
+			t -> last = n < FILE_CHUNK ? TRUE : FALSE;
+			t -> state = FS_READ;
+		}
+		pthread_cond_broadcast (&job -> cond);
+		pthread_mutex_unlock (&job -> lock);
+		if ((n < 0) || (n < FILE_CHUNK))
+			break;
+	}
+
+	return NULL;
+}
+
+/*
+	Thread driver: writes the output of every slot, in order, up to the last.
+	Output transcoded before an error elsewhere is still written.
+*/
+static void* EN_FileWriter (void* p) {
+	struct FILEJOB* job;
+	struct FILESLOT* t;
+	unsigned long long q;
+	BOOL ok, last;
+
+	job = (struct FILEJOB*) p;
+	for (q = 0; ; q++) {
+		t = &job -> slots[q % FILE_SLOTS];
+		pthread_mutex_lock (&job -> lock);
+		while ((t -> state != FS_CONVERTED) && !job -> stop)
+			pthread_cond_wait (&job -> cond, &job -> lock);
+		if (t -> state != FS_CONVERTED) {
+			pthread_mutex_unlock (&job -> lock);
+			break;
+		}
+		pthread_mutex_unlock (&job -> lock);
+		ok = EN_FileWriteAll (job -> outfd, t -> out, t -> nout);
+		pthread_mutex_lock (&job -> lock);
+		if (!ok) {
+			job -> error = errno;
+			job -> stop = TRUE;
+		}
+		last = t -> last;
+		t -> state = FS_FREE;
+		pthread_cond_broadcast (&job -> cond);
+		pthread_mutex_unlock (&job -> lock);
+		if (!ok || last)
+			break;
+	}
+
+	return NULL;
+}
+
+/*
+	Runs a job with a reader and a writer thread around the calling one, which
+	transcodes. FALSE if the threads can't be started.
+*/
+static BOOL EN_FileRunThreads (struct FILEJOB* job) {
+	pthread_t reader, writer;
+	struct FILESLOT* t;
+	unsigned long long q;
+	BOOL last;
+
+	if (pthread_mutex_init (&job -> lock, NULL) != 0)
+		return FALSE;
+	if (pthread_cond_init (&job -> cond, NULL) != 0) {
+		pthread_mutex_destroy (&job -> lock);
+		return FALSE;
+	}
+	if (pthread_create (&reader, NULL, EN_FileReader, job) != 0) {
+		job -> error = EAGAIN;
+		pthread_cond_destroy (&job -> cond);
+		pthread_mutex_destroy (&job -> lock);
+		return FALSE;
+	}
+	if (pthread_create (&writer, NULL, EN_FileWriter, job) != 0) {
+		pthread_mutex_lock (&job -> lock);
+		job -> error = EAGAIN;
+		job -> stop = TRUE;
+		pthread_cond_broadcast (&job -> cond);
+		pthread_mutex_unlock (&job -> lock);
+		pthread_join (reader, NULL);
+		pthread_cond_destroy (&job -> cond);
+		pthread_mutex_destroy (&job -> lock);
+		return FALSE;
+	}
+	for (q = 0; ; q++) {
+		t = &job -> slots[q % FILE_SLOTS];
+		pthread_mutex_lock (&job -> lock);
+		while ((t -> state != FS_READ) && !job -> stop)
+			pthread_cond_wait (&job -> cond, &job -> lock);
+		if (t -> state != FS_READ) {
+			pthread_mutex_unlock (&job -> lock);
+			break;
+		}
+		pthread_mutex_unlock (&job -> lock);
+		EN_FileConvertSlot (job, t);
+		pthread_mutex_lock (&job -> lock);
+		t -> state = FS_CONVERTED;
+		// The writer still writes up to this slot, the reader stops.
+		if (job -> bad)
+			job -> stop = TRUE;
+		last = t -> last;
+		pthread_cond_broadcast (&job -> cond);
+		pthread_mutex_unlock (&job -> lock);
+		if (last)
+			break;
+	}
+	pthread_join (reader, NULL);
+	pthread_join (writer, NULL);
+	pthread_cond_destroy (&job -> cond);
+	pthread_mutex_destroy (&job -> lock);
+
+	return TRUE;
+}
+
+#ifdef EN_FILE_URING
+
+// Requests in flight at most: a read and a write by slot.
+#define RING_ENTRIES (2 * FILE_SLOTS)
+// Completion data of a write, or'ed with the slot number.
+#define RING_WRITE 0x100
+// Completion data of the cancel of a request, or'ed with the request's data.
+#define RING_CANCEL 0x200
+
+/*
+	An io_uring, set up with the system calls alone. "queued" counts the
+	requests put on the submission ring and not submitted yet.
+*/
+struct FILERING {
+	int fd;
+	void* sq;
+	void* cq;
+	size_t nsq;
+	size_t ncq;
+	struct io_uring_sqe* sqes;
+	size_t nsqes;
+	unsigned int* sqtail;
+	unsigned int* sqmask;
+	unsigned int* sqarray;
+	unsigned int* cqhead;
+	unsigned int* cqtail;
+	unsigned int* cqmask;
+	struct io_uring_cqe* cqes;
+	unsigned int queued;
+};
+
+/*
+	Sets up a ring. FALSE if the kernel has none, or an old one: reads and
+	writes without vectors came in Linux 5.6, and fast poll, which is checked
+	instead, in 5.7.
+*/
+static BOOL EN_RingInit (struct FILERING* r) {
+	struct io_uring_params p;
+	BYTE *sq, *cq;
+
+	memset (&p, 0, sizeof (p));
+	if ((r -> fd = (int) syscall (__NR_io_uring_setup, RING_ENTRIES, &p)) < 0)
+		return FALSE;
+	if (!(p.features & IORING_FEAT_FAST_POLL)) {
+		close (r -> fd);
+		return FALSE;
+	}
+	r -> nsq = p.sq_off.array + p.sq_entries * sizeof (unsigned int);
+	r -> ncq = p.cq_off.cqes + p.cq_entries * sizeof (struct io_uring_cqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP)
+		r -> nsq = r -> ncq = r -> nsq > r -> ncq ? r -> nsq : r -> ncq;
+	r -> nsqes = p.sq_entries * sizeof (struct io_uring_sqe);
+	r -> sq = mmap (NULL, r -> nsq, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r -> fd, IORING_OFF_SQ_RING);
+	r -> cq = (p.features & IORING_FEAT_SINGLE_MMAP) || (r -> sq == MAP_FAILED) ? r -> sq :
+			mmap (NULL, r -> ncq, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r -> fd, IORING_OFF_CQ_RING);
+	r -> sqes = (struct io_uring_sqe*) mmap (NULL, r -> nsqes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			r -> fd, IORING_OFF_SQES);
+	if ((r -> sq == MAP_FAILED) || (r -> cq == MAP_FAILED) || (r -> sqes == MAP_FAILED)) {
+		if (r -> sqes != MAP_FAILED)
+			munmap (r -> sqes, r -> nsqes);
+		if ((r -> cq != MAP_FAILED) && (r -> cq != r -> sq))
+			munmap (r -> cq, r -> ncq);
+		if (r -> sq != MAP_FAILED)
+			munmap (r -> sq, r -> nsq);
+		close (r -> fd);
+		return FALSE;
+	}
+	sq = (BYTE*) r -> sq;
+	cq = (BYTE*) r -> cq;
+	r -> sqtail = (unsigned int*) (sq + p.sq_off.tail);
+	r -> sqmask = (unsigned int*) (sq + p.sq_off.ring_mask);
+	r -> sqarray = (unsigned int*) (sq + p.sq_off.array);
+	r -> cqhead = (unsigned int*) (cq + p.cq_off.head);
+	r -> cqtail = (unsigned int*) (cq + p.cq_off.tail);
+	r -> cqmask = (unsigned int*) (cq + p.cq_off.ring_mask);
+	r -> cqes = (struct io_uring_cqe*) (cq + p.cq_off.cqes);
+	r -> queued = 0;
+
+	return TRUE;
+}
+
+static void EN_RingFree (struct FILERING* r) {
+	munmap (r -> sqes, r -> nsqes);
+	if (r -> cq != r -> sq)
+		munmap (r -> cq, r -> ncq);
+	munmap (r -> sq, r -> nsq);
+	close (r -> fd);
+}
+
+/*
+	Queues a read or write ("op") of "n" bytes of "p" at "offset" of "fd",
+	(unsigned long long) -1 for its position. "data" comes back with the
+	completion.
+*/
+static void EN_RingQueue (struct FILERING* r, BYTE op, int fd, BYTE* p, unsigned int n,
+			unsigned long long offset, unsigned long long data) {
+	struct io_uring_sqe* e;
+	unsigned int tail, k;
+
+	tail = *r -> sqtail;
+	k = tail & *r -> sqmask;
+	e = &r -> sqes[k];
+	memset (e, 0, sizeof (*e));
+	e -> opcode = op;
+	e -> fd = fd;
+	e -> addr = (unsigned long long) (unsigned long) p;
+	e -> len = n;
+	e -> off = offset;
+	e -> user_data = data;
+	r -> sqarray[k] = k;
+	__atomic_store_n (r -> sqtail, tail + 1, __ATOMIC_RELEASE);
+	r -> queued++;
+}
+
+/*
+	Submits the queued requests and, with "wait", waits for a completion.
+	FALSE on error.
+*/
+static BOOL EN_RingEnter (struct FILERING* r, BOOL wait) {
+	long n;
+
+	if ((r -> queued == 0) && !wait)
+		return TRUE;
+	do
+		n = syscall (__NR_io_uring_enter, r -> fd, r -> queued, wait ? 1 : 0, wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+	while ((n < 0) && (errno == EINTR));
+	if (n < 0)
+		return FALSE;
+	r -> queued -= (unsigned int) n;
+
+	return TRUE;
+}
+
+/*
+	Takes a completion, if there's one.
+*/
+static BOOL EN_RingReap (struct FILERING* r, unsigned long long* data, int* res) {
+	struct io_uring_cqe* e;
+	unsigned int head;
+
+	head = *r -> cqhead;
+	if (head == __atomic_load_n (r -> cqtail, __ATOMIC_ACQUIRE))
+		return FALSE;
+	e = &r -> cqes[head & *r -> cqmask];
+	*data = e -> user_data;
+	*res = e -> res;
+	__atomic_store_n (r -> cqhead, head + 1, __ATOMIC_RELEASE);
+
+	return TRUE;
+}
+
+/*
+	Queues the read of the rest of the chunk of "t", or the next bytes of it
+	for a file without offsets.
+*/
+static void EN_RingRead (struct FILEJOB* job, struct FILERING* r, unsigned int k) {
+	struct FILESLOT* t;
+
+	t = &job -> slots[k];
+	EN_RingQueue (r, IORING_OP_READ, job -> infd, t -> in + FILE_CARRY + t -> nin, FILE_CHUNK - t -> nin,
+			job -> inseek ? t -> offset + t -> nin : (unsigned long long) -1, k);
+}
+
+static void EN_RingWrite (struct FILEJOB* job, struct FILERING* r, unsigned int k) {
+	struct FILESLOT* t;
+
+	t = &job -> slots[k];
+	EN_RingQueue (r, IORING_OP_WRITE, job -> outfd, t -> out + t -> done, t -> nout - t -> done,
+			job -> outseek ? t -> offset + t -> done : (unsigned long long) -1, k | RING_WRITE);
+}
+
+/*
+	Asks the kernel to cancel the requests in flight, when the job stops.
+	They still complete, with -ECANCELED if they were cancelled.
+*/
+static void EN_RingCancel (struct FILEJOB* job, struct FILERING* r) {
+	unsigned long long data;
+	unsigned int k;
+
+	for (k = 0; k < FILE_SLOTS; k++) {
+		if (job -> slots[k].state == FS_READING)
+			data = k;
+		else if (job -> slots[k].state == FS_WRITING)
+			data = k | RING_WRITE;
+		else
+			continue;
+		// The request to cancel goes by its data, on "addr".
+		EN_RingQueue (r, IORING_OP_ASYNC_CANCEL, -1, (BYTE*) (unsigned long) data, 0, 0, data | RING_CANCEL);
+	}
+}
+
+/*
+	Handles a failed io_uring_enter(): the job stops with its errno, and
+	the requests the kernel didn't take are taken back from the submission
+	ring, so "reading" and "writing" count only those in flight. These own
+	their buffers until they complete, so the caller still reaps them. It
+	waits a bit before trying again, which also lets the kernel post
+	completions.
+*/
+static void EN_RingFailed (struct FILEJOB* job, struct FILERING* r, unsigned int* reading, unsigned int* writing) {
+	struct timespec nap;
+	unsigned long long data;
+	unsigned int tail;
+
+	if (job -> error == 0)
+		job -> error = errno;
+	job -> stop = TRUE;
+	while (r -> queued > 0) {
+		tail = *r -> sqtail - 1;
+		data = r -> sqes[tail & *r -> sqmask].user_data;
+		if (!(data & RING_CANCEL)) {
+			if (data & RING_WRITE)
+				(*writing)--;
+			else
+				(*reading)--;
+		}
+		__atomic_store_n (r -> sqtail, tail, __ATOMIC_RELEASE);
+		r -> queued--;
+	}
+	nap.tv_sec = 0;
+	nap.tv_nsec = 1000000;
+	nanosleep (&nap, NULL);
+}
+
+/*
+	Runs a job on ring "r" from the calling thread. Reads are queued in chunk
+	order as slots get free, and writes as chunks are transcoded. A chunk is
+	read until it's full (but from a file without offsets, where any read
+	ends it) or the file ends, and written until all of its output is. On
+	an error the requests in flight are cancelled, and it only returns once
+	all of them completed, for the buffers to be freed.
+*/
+static void EN_FileRunRing (struct FILEJOB* job, struct FILERING* r) {
+	unsigned long long rq, cq, wq, lastq, inend, data;
+	unsigned int reading, writing, k;
+	struct FILESLOT* t;
+	BOOL eof, cancelled;
+	int res;
+
+	// Next chunk to read, transcode and write, and the last one once known.
+	rq = cq = wq = 0;
+	lastq = ~0ULL;
+	inend = job -> inoff;
+	reading = writing = 0;
+	eof = cancelled = FALSE;
+	for (;;) {
+		while (!eof && !job -> stop && (lastq == ~0ULL) && (job -> slots[rq % FILE_SLOTS].state == FS_FREE) &&
+				(job -> inseek || (reading == 0))) {
+			t = &job -> slots[rq % FILE_SLOTS];
+			t -> seq = rq++;
+			t -> offset = job -> inoff;
+			t -> nin = 0;
+			t -> last = FALSE;
+			t -> state = FS_READING;
+			job -> inoff += FILE_CHUNK;
+			EN_RingRead (job, r, t - job -> slots);
+			reading++;
+		}
+		while (!job -> stop && (wq < cq) && (job -> slots[wq % FILE_SLOTS].state == FS_CONVERTED) &&
+				(job -> outseek || (writing == 0))) {
+			t = &job -> slots[wq++ % FILE_SLOTS];
+			t -> offset = job -> outoff;
+			job -> outoff += t -> nout;
+			if (t -> nout == 0) {
+				t -> state = FS_FREE;
+				continue;
+			}
+			t -> state = FS_WRITING;
+			EN_RingWrite (job, r, t - job -> slots);
+			writing++;
+		}
+		if (job -> stop && !cancelled) {
+			EN_RingCancel (job, r);
+			cancelled = TRUE;
+		}
+		if (!EN_RingEnter (r, FALSE)) {
+			EN_RingFailed (job, r, &reading, &writing);
+			cancelled = FALSE;
+		}
+		if ((reading == 0) && (writing == 0) && (job -> stop || (wq > lastq)))
+			break;
+		// Transcodes while the requests run.
+		t = &job -> slots[cq % FILE_SLOTS];
+		if (!job -> stop && (cq <= lastq) && (t -> state == FS_READ) && (t -> seq == cq)) {
+			EN_FileConvertSlot (job, t);
+			t -> state = FS_CONVERTED;
+			if (t -> last)
+				lastq = cq;
+			cq++;
+			continue;
+		}
+		if (!EN_RingReap (r, &data, &res)) {
+			if (!EN_RingEnter (r, TRUE)) {
+				EN_RingFailed (job, r, &reading, &writing);
+				cancelled = FALSE;
+			}
+			continue;
+		}
+		if (data & RING_CANCEL)
+			continue;
+		k = (unsigned int) (data & ~RING_WRITE);
+		t = &job -> slots[k];
+		// Once stopped, completions are only drained.
+		if (data & RING_WRITE) {
+			writing--;
+			if (job -> stop)
+				t -> state = FS_FREE;
+			else if ((res == -EINTR) || (res == -EAGAIN) || ((res > 0) && ((t -> done += (unsigned int) res) < t -> nout))) {
+				EN_RingWrite (job, r, k);
+				writing++;
+			} else if (res <= 0) {
+				job -> error = res < 0 ? -res : EIO;
+				job -> stop = TRUE;
+			} else
+				t -> state = FS_FREE;
+			continue;
+		}
+		reading--;
+		if (job -> stop)
+			t -> state = FS_FREE;
+		else if ((res == -EINTR) || (res == -EAGAIN) || ((res > 0) && job -> inseek && ((t -> nin += (unsigned int) res) < FILE_CHUNK))) {
+			EN_RingRead (job, r, k);
+			reading++;
+		} else if (res < 0) {
+			job -> error = -res;
+			job -> stop = TRUE;
+		} else {
+			if (!job -> inseek)
+				t -> nin = (unsigned int) res;
+			if (res == 0)
+				eof = t -> last = TRUE;
+			if ((t -> nin > 0) && (inend < t -> offset + t -> nin))
+				inend = t -> offset + t -> nin;
+			t -> state = FS_READ;
+		}
+	}
+	// Leaves the files where blocking I/O would have.
+	if (job -> inseek)
+		lseek (job -> infd, (off_t) inend, SEEK_SET);
+	if (job -> outseek)
+		lseek (job -> outfd, (off_t) job -> outoff, SEEK_SET);
+}
+
+#endif
+
+/*
+	Transcodes the file "infd", on encoding "inenc", to "outfd" on encoding
+	"outenc", from their current positions and up to the end of "infd". The
+	files can be of any kind (regular files, pipes, sockets) and are left
+	after the last byte read and written. Memory use doesn't depend on their
+	size.
+
+	[Params]
+		infd: File descriptor to read.
+		inenc: Encoding of "infd". No BOM is read.
+		outfd: File descriptor to write.
+		outenc: Encoding to write. No BOM is written.
+
+	[Return]
+		TRUE on success. FALSE if the input is malformed, or has characters
+		"outenc" lacks, with errno set to EILSEQ and the output of all the
+		characters before written; or if reading or writing fails, with errno
+		set to the error. Same encodings are copied without checking.
+*/
+BOOL EN_TranscodeFile (int infd, enum ENCODING inenc, int outfd, enum ENCODING outenc) {
+	struct FILEJOB job;
+	unsigned int k;
+	BOOL ok;
+#ifdef EN_FILE_URING
+	struct FILERING r;
+#endif
+
+	if ((inenc < ENC_UTF8) || (inenc > ENC_ASCII) || (outenc < ENC_UTF8) || (outenc > ENC_ASCII)) {
+		errno = EINVAL;
+		return FALSE;
+	}
+	memset (&job, 0, sizeof (job));
+	job.infd = infd;
+	job.outfd = outfd;
+	job.inenc = inenc;
+	job.outenc = outenc;
+	job.inseek = EN_FileSeekable (infd, FALSE, &job.inoff);
+	job.outseek = EN_FileSeekable (outfd, TRUE, &job.outoff);
+	ok = TRUE;
+	for (k = 0; k < FILE_SLOTS; k++) {
+		job.slots[k].in = (BYTE*) malloc (FILE_CARRY + FILE_CHUNK);
+		job.slots[k].out = (BYTE*) malloc (FILE_OUTSIZE);
+		if ((job.slots[k].in == NULL) || (job.slots[k].out == NULL))
+			ok = FALSE;
+	}
+	if (!ok)
+		job.error = ENOMEM;
+#ifdef EN_FILE_URING
+	else if (EN_RingInit (&r)) {
+		EN_FileRunRing (&job, &r);
+		EN_RingFree (&r);
+	}
+#endif
+	else if (!EN_FileRunThreads (&job) && (job.error == 0))
+		job.error = EAGAIN;
+	for (k = 0; k < FILE_SLOTS; k++) {
+		free (job.slots[k].in);
+		free (job.slots[k].out);
+	}
+	if (job.error != 0)
+		errno = job.error;
+	else if (job.bad)
+		errno = EILSEQ;
+
+	return !job.bad && (job.error == 0) ? TRUE : FALSE;
+}
@@ -0,0 +1,198 @@
+/*
+	File: utf8test.c
+	Creation: 19-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Exhaustive test of the UTF-8 codec of encoding.h against a reference
+		written bit by bit from RFC 2279, with no tables. EN_UTF8ToUCS4() is
+		run on every sequence of 1 to 4 bytes, and EN_UCS4ToUTF8() on every
+		code point, then on every 64th value up to 0x7FFFFFFF, each result
+		decoded back.
+
+		Build from the repository root:
+
+			cc -O2 -pthread -DARCH_LITTLE_ENDIAN -Iencoding/include \
+				encoding/test/utf8test.c encoding/src/[a-z]*.c -o utf8test
+
+		Usage:
+
+			utf8test
+
+		Mismatches go to stdout, the first ones in full, and the exit status
+		is not zero if there is any.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "encoding.h"
+
+// Mismatches printed in full.
+#define UT_MAX_REPORTS 20
+
+static unsigned long long Failures = 0;
+
+/*
+	Smallest value of a sequence of "len" bytes, as shorter ones are overlong.
+*/
+static const UCS4 UTMINIMUM[7] = {0, 0, 0x80, 0x800, 0x10000, 0x200000, 0x4000000};
+
+/*
+	Reference decoder. Reads the bytes of "s" one at a time and stops on the
+	first one that can't go on, as the decoder must: a byte that isn't a
+	continuation, or one after which every ending is overlong. A sequence cut
+	by the end of "n" sets "*eob". On error "*at" is the failed byte, and on
+	success the length.
+*/
+static BOOL UT_Decode (const BYTE* s, unsigned int n, UCS4* c, unsigned int* at, BOOL* eob) {
+	unsigned int len, i, left;
+	UCS4 v, top;
+
+	*eob = FALSE;
+	*at = 0;
+	if (n == 0) {
+		*eob = TRUE;
+		return FALSE;
+	}
+	if (s[0] < 0x80) {
+		*c = s[0];
+		*at = 1;
+		return TRUE;
+	}
+	// Leading ones tell the length, 2 to 6.
+	for (len = 0; (len < 8) && (s[0] & (0x80 >> len)); len++)
+		;
+	if ((len < 2) || (len > 6))
+		return FALSE;
+	v = s[0] & (0x7F >> len);
+	for (i = 0; ; ) {
+		// Largest value the sequence may still reach.
+		left = len - 1 - i;
+		top = left ? (v << 6 * left) | ((1U << 6 * left) - 1) : v;
+		if (top < UTMINIMUM[len]) {
+			*at = i;
+			return FALSE;
+		}
+		if (++i == len)
+			break;
+		if (i >= n) {
+			*eob = TRUE;
+			return FALSE;
+		}
+		if ((s[i] & 0xC0) != 0x80) {
+			*at = i;
+			return FALSE;
+		}
+		v = v << 6 | (s[i] & 0x3F);
+	}
+	*c = v;
+	*at = len;
+
+	return TRUE;
+}
+
+/*
+	Reference encoder. Returns the length, 0 for values above 0x7FFFFFFF.
+*/
+static unsigned int UT_Encode (UCS4 c, BYTE* d) {
+	unsigned int len, k;
+
+	if (c > 0x7FFFFFFF)
+		return 0;
+	if (c < 0x80) {
+		d[0] = (BYTE) c;
+		return 1;
+	}
+	for (len = 2; (len < 6) && (c >= UTMINIMUM[len + 1]); len++)
+		;
+	for (k = len - 1; k > 0; k--, c >>= 6)
+		d[k] = (BYTE) (0x80 | (c & 0x3F));
+	d[0] = (BYTE) ((0xFF00 >> len) | c);
+
+	return len;
+}
+
+static void UT_Fail (const char* what, const BYTE* s, unsigned int n, UCS4 c) {
+	unsigned int i;
+
+	if (Failures++ >= UT_MAX_REPORTS)
+		return;
+	printf ("%s:", what);
+	for (i = 0; i < n; i++)
+		printf (" %02X", s[i]);
+	printf (" (%08X)\n", (unsigned int) c);
+}
+
+/*
+	Decodes "s" of "n" bytes with EN_UTF8ToUCS4() and the reference. The index
+	on error and "eob" must agree too.
+*/
+static void UT_CheckDecode (BYTE* s, unsigned int n) {
+	struct ENCSTREAM st;
+	unsigned int at;
+	UCS4 c, r;
+	BOOL ok, eob;
+
+	EN_InitStream (&st, s, n);
+	c = r = 0;
+	ok = EN_UTF8ToUCS4 (&st, &c);
+	if (UT_Decode (s, n, &r, &at, &eob)) {
+		if (!ok || (c != r) || (st.index != at))
+			UT_Fail ("decode", s, n, c);
+	} else if (ok || (!eob != !st.eob) || (!eob && (st.index != at)))
+		UT_Fail ("reject", s, n, c);
+}
+
+/*
+	Encodes "c" with EN_UCS4ToUTF8() and the reference, and decodes it back.
+*/
+static void UT_CheckEncode (UCS4 c) {
+	BYTE d[8], r[8];
+	struct ENCSTREAM st;
+	unsigned int n;
+	UCS4 back;
+
+	EN_InitStream (&st, d, sizeof (d));
+	n = UT_Encode (c, r);
+	if (!EN_UCS4ToUTF8 (c, &st) != !n) {
+		UT_Fail ("encode", d, st.index, c);
+		return;
+	}
+	if (n == 0)
+		return;
+	if ((st.index != n) || memcmp (d, r, n)) {
+		UT_Fail ("encode", d, st.index, c);
+		return;
+	}
+	EN_InitStream (&st, d, n);
+	if (!EN_UTF8ToUCS4 (&st, &back) || (back != c) || (st.index != n))
+		UT_Fail ("round trip", d, n, c);
+}
+
+int main (void) {
+	unsigned long long x;
+	unsigned int n, k;
+	BYTE s[4];
+	UCS4 c;
+
+	for (n = 1; n <= 4; n++) {
+		for (x = 0; x < 1ULL << 8 * n; x++) {
+			for (k = 0; k < n; k++)
+				s[k] = (BYTE) (x >> 8 * (n - 1 - k));
+			UT_CheckDecode (s, n);
+		}
+		printf ("decode, %u bytes: done\n", n);
+	}
+	for (c = 0; c <= 0x10FFFF; c++)
+		UT_CheckEncode (c);
+	for (c = 0x110000; c <= 0x7FFFFFC0; c += 64)
+		UT_CheckEncode (c);
+	UT_CheckEncode (0x7FFFFFFF);
+	UT_CheckEncode (0x80000000);
+	UT_CheckEncode (0xFFFFFFFF);
+	printf ("encode: done\n");
+	printf ("%llu failures\n", Failures);
+
+	return Failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -10,12 +10,79 @@
 #ifndef LOG_H
 #define LOG_H
 
+#include <stdio.h>
 #include "defs.h"
 
-	enum LOGKIND {LOGERROR, LOGWARNING, LOGINFORMATION};
+	/* From the most to the least severe. */
+	enum LOGKIND {LOGERROR, LOGWARNING, LOGINFORMATION, LOGDEBUG, LOGTRACE};
+	/* What an asynchronous log does with its queue full. */
+	enum LOGFULL {LOGBLOCK, LOGDROP, LOGCOUNT};
+	/* Fraction of second on the time of a line. */
+	enum LOGPRECISION {LOGSECONDS, LOGMILLISECONDS, LOGMICROSECONDS};
 
 	void LOG_WriteLog (enum LOGKIND kind, const char* msg, ...);
+	void LOG_WriteBinary (enum LOGKIND kind, unsigned int id, const char* format, ...);
+	unsigned int LOG_RegisterFormat (const char* format);
 	BOOL LOG_OpenLogFile (char* filename);
+	BOOL LOG_OpenLogFileAsync (char* filename, unsigned int length, enum LOGFULL full);
+	BOOL LOG_OpenBinaryLogFile (char* filename, unsigned int length, enum LOGFULL full);
+	BOOL LOG_DecodeLogFile (char* filename, FILE* out);
+	void LOG_SetPrecision (enum LOGPRECISION precision);
+	void LOG_SetLevel (enum LOGKIND level);
+	enum LOGKIND LOG_GetLevel ();
+	unsigned long long LOG_GetDropped ();
 	void LOG_CloseLogFile ();
 
+	/* Least severe kind logged, for the macros. Set with "LOG_SetLevel()". */
+	extern enum LOGKIND LogLevel;
+
+/*
+	Least severe kind compiled in. Calls of the macros for kinds below it are
+	constant false and removed, arguments and all.
+*/
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOGTRACE
+#endif
+
+/*
+	Tells if messages of "kind" are logged, with a single branch on the level,
+	expected not to be, for the call to be kept out of the hot path.
+*/
+#define LOG_ENABLED(kind) (((kind) <= LOG_MIN_LEVEL) && \
+		__builtin_expect ((kind) <= __atomic_load_n (&LogLevel, __ATOMIC_RELAXED), 0))
+
+/*
+	Logs a message with "LOG_WriteLog()" if "kind" is enabled. The arguments
+	aren't evaluated otherwise.
+*/
+#define LOG_WRITE(kind, msg, ...) do { \
+		if (LOG_ENABLED (kind)) \
+			LOG_WriteLog (kind, msg, ##__VA_ARGS__); \
+	} while (0)
+
+/*
+	Id kept by "LOG_BINARY()" for a format that "LOG_RegisterFormat()" turned
+	down, so the call site goes to the text path without trying again.
+*/
+#define LOG_NOFORMAT 0xFFFFFFFFU
+
+/*
+	Logs a message with "LOG_WriteBinary()", registering "format" the first
+	time the call site runs, if "kind" is enabled as for "LOG_WRITE()".
+	"format" should be a literal. If it can't be registered, the message is
+	formatted as text.
+*/
+#define LOG_BINARY(kind, format, ...) do { \
+		static unsigned int logid_; \
+		unsigned int id_; \
+		if (LOG_ENABLED (kind)) { \
+			if ((id_ = __atomic_load_n (&logid_, __ATOMIC_ACQUIRE)) == 0) { \
+				if ((id_ = LOG_RegisterFormat (format)) == 0) \
+					id_ = LOG_NOFORMAT; \
+				__atomic_store_n (&logid_, id_, __ATOMIC_RELEASE); \
+			} \
+			LOG_WriteBinary (kind, id_ == LOG_NOFORMAT ? 0 : id_, format, ##__VA_ARGS__); \
+		} \
+	} while (0)
+
 #endif
@@ -5,6 +5,43 @@
 	Description:
 		
 		Open a log file and manages the post of message logs to that file.
+
+		In asynchronous mode callers don't touch the file: they format their
+		message into a slot of a bounded lock-free queue, many producers and a
+		single consumer, and a writer thread drains it in batches, flushing
+		the file when the queue runs empty. Then it waits for a message, and
+		some more for the batch to gather, so producers seldom wake it. A
+		slot is claimed with a CAS on the tail, and its sequence number tells
+		the writer when it's filled and the producers when it's free again.
+
+		Every thread formats on buffers of its own, bounded to their size, so
+		threads format in parallel with no lock. The line is then appended
+		with a single fwrite(), serialized by the lock of the stream.
+
+		The head of a line, its date and time, is only built when the second
+		changes, and kept by every thread. Lines of the same second copy it and
+		put the fraction of second, if any, after it. Time comes from the coarse
+		real time clock while it's precise enough, which costs much less.
+
+		A binary log is asynchronous too, but a message is left unformatted.
+		Call sites register their format once and get an id, and a record has
+		only that id, the time and the arguments, packed. Its file is a
+		sequence of records, all starting with the id as a varint:
+
+			0, 0, "LOGBIN", version, precision, 0x0102 as a native WORD:
+				head of the file, again every time it's opened.
+			0, id, length, format: definition of a format, before its use.
+			id, time, length, arguments: a message. Time is in nanoseconds,
+				the difference with the last record, zigzag encoded. Id 1 is
+				text already formatted, as a string.
+
+		Integers go as varints, zigzag encoded if signed, floating point
+		numbers as native doubles and strings as their length and bytes.
+		"LOG_DecodeLogFile()" turns it back into the text of a plain log.
+
+		Messages less severe than the level are ignored. The macros check it
+		before the arguments are evaluated, and the kinds below
+		"LOG_MIN_LEVEL" aren't even compiled.
 */
 
 #include <string.h>
@@ -12,22 +49,123 @@
 #include <time.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
 #include "defs.h"
-#include "logfile.h"
+#include "log.h"
 
-#define MAX_NUMBER_TEXT_LENGTH 10
 #define MAX_FORMATED_TEXT_LENGTH 512
+/* "[dd/mm/yyyy][hh:mm:ss", with room to spare. */
+#define MAX_HEAD_TEXT_LENGTH 32
+/* The head and the longest message, with room to spare. */
 #define MAX_TEMP_TEXT_LENGTH 640
+/* Queue slots when none are requested. */
+#define DEFAULT_QUEUE_LENGTH 1024
+/* File buffer of the writer thread, which is a batch at most. */
+#define ASYNC_BUFFER_LENGTH (64 * 1024)
+/* Time the writer thread lets a batch gather, in milliseconds. */
+#define BATCH_INTERVAL 10
+/* Keeps the producer and consumer ends on their own cache lines. */
+#define CACHE_LINE 64
+
+/* Formats that can be registered, and arguments of a format. */
+#define MAX_FORMATS 1024
+#define MAX_FORMAT_ARGS 16
+/* Ids of the records of a binary log that aren't messages of a format. */
+#define BINARY_CONTROL 0
+#define BINARY_TEXT 1
+#define BINARY_MAGIC "LOGBIN"
+#define BINARY_VERSION 1
+/* A conversion specification, as it's passed to snprintf(). */
+#define MAX_SPEC_LENGTH 32
+
+#ifdef CLOCK_REALTIME_COARSE
+#define COARSE_CLOCK CLOCK_REALTIME_COARSE
+#else
+#define COARSE_CLOCK CLOCK_REALTIME
+#endif
+
+/*
+	A queued message. "seq" is the position it's free for, and that plus one
+	once it's filled.
+*/
+typedef struct logslot_s {
+	unsigned int seq;
+	/* Format of a binary message and its arguments on "text", 0 for text. */
+	unsigned int id;
+	unsigned int size;
+	struct timespec time;
+	char text[MAX_FORMATED_TEXT_LENGTH + 1];
+} logslot_t;
+
+/*
+	Formatting buffers of a thread, and its head for second "second".
+*/
+typedef struct logbuffers_s {
+	time_t second;
+	unsigned int headlen;
+	char head[MAX_HEAD_TEXT_LENGTH];
+	char formated[MAX_FORMATED_TEXT_LENGTH + 1];
+	char temp[MAX_TEMP_TEXT_LENGTH + 1];
+} logbuffers_t;
+
+/* States of the writer thread, for producers to know when to wake it. */
+enum LOGWRITER {WRITER_AWAKE, WRITER_IDLE, WRITER_NAPPING};
 
 typedef struct logfile_s {
 	FILE* file;
-	char* num;
-	char* formated;
-	char* temp;
+	/* Asynchronous mode, and binary on top of it. */
+	BOOL async;
+	BOOL binary;
+	long long last;
+	enum LOGFULL full;
+	logslot_t* slots;
+	unsigned int mask;
+	unsigned long long dropped;
+	unsigned long long unreported;
+	pthread_t writer;
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	enum LOGWRITER sleeping;
+	BOOL stop;
+	unsigned int head;
+	char pad[CACHE_LINE];
+	unsigned int tail;
+	char pad1[CACHE_LINE - sizeof (unsigned int)];
 } logfile_t;
 
+/*
+	Types of the arguments of a format, as they're read from a "va_list".
+	Signed integers go first, then unsigned ones.
+*/
+enum LOGARG {ARG_SCHAR, ARG_SHORT, ARG_INT, ARG_LONG, ARG_LLONG, ARG_INTMAX, ARG_SSIZE, ARG_PTRDIFF,
+	ARG_UCHAR, ARG_USHORT, ARG_UINT, ARG_ULONG, ARG_ULLONG, ARG_UINTMAX, ARG_SIZE, ARG_UPTRDIFF,
+	ARG_DOUBLE, ARG_LDOUBLE, ARG_STRING, ARG_POINTER};
+
+/*
+	A registered format. "precision" is the one of string arguments: -1 for
+	none and -2 if it's taken from the argument before.
+*/
+typedef struct logformat_s {
+	const char* format;
+	unsigned int count;
+	BYTE args[MAX_FORMAT_ARGS];
+	int precision[MAX_FORMAT_ARGS];
+} logformat_t;
+
 /* Only one logfile allowed at a time. */
-struct LOGFILE* LogFile = NULL;
+logfile_t* LogFile = NULL;
+/* Debug and trace messages are left out by default. */
+enum LOGKIND LogLevel = LOGINFORMATION;
+static __thread logbuffers_t LogBuffers;
+static enum LOGPRECISION LogPrecision = LOGSECONDS;
+static clockid_t LogClock = COARSE_CLOCK;
+/* Registered formats, from id 2 on, kept across log files. */
+static logformat_t LogFormats[MAX_FORMATS];
+static unsigned int LogFormatCount = BINARY_TEXT + 1;
+static pthread_mutex_t LogFormatLock = PTHREAD_MUTEX_INITIALIZER;
 
 /*
 	Creates and initialize a log-file structure and return it.
@@ -35,155 +173,525 @@ struct LOGFILE* LogFile = NULL;
 logfile_t* LOG_NewLogFile () {
 	logfile_t* lf;
 
-	if ((lf = (struct LOGFILE*) malloc (sizeof (logfile_t))) == NULL)
+	if ((lf = (logfile_t*) malloc (sizeof (logfile_t))) == NULL)
 		return NULL;
 
-	if ((lf->num = (char*) malloc (MAX_NUMBER_TEXT_LENGTH + 1)) == NULL)
-		goto fail;
-
-	if ((lf->formated = (char*) malloc (MAX_FORMATED_TEXT_LENGTH + 1)) == NULL)
-		goto fail1;
-
-	if ((lf->temp = (char*) malloc (MAX_TEMP_TEXT_LENGTH + 1)) == NULL)
-		goto fail2;
-
 	lf->file = NULL;
-	memset (lf->num, 0, MAX_NUMBER_TEXT_LENGTH + 1);
-	memset (lf->formated, 0, MAX_FORMATED_TEXT_LENGTH + 1);
-	memset (lf->temp, 0, MAX_TEMP_TEXT_LENGTH + 1);
+	lf->async = FALSE;
+	lf->binary = FALSE;
+	lf->last = 0;
+	lf->slots = NULL;
 
 	return lf;
-		
-fail2:
-	free (lf->formated);
-fail1:
-	free (lf->num);
-fail:
-	free (lf);
-
-	return NULL;
 }
 
 /*
 	Frees a LOGFILE structure.
 */
 void LOG_FreeLogFile (logfile_t* lf) {
-	free (lf->num);
-	free (lf->formated);
-	free (lf->temp);
+	free (lf->slots);
 	free (lf);
 }
 
+/*
+	Puts "v" on "dest" as "n" decimal digits, with leading zeros, and returns
+	the end.
+*/
+static char* LOG_PutDigits (char* dest, unsigned long v, unsigned int n) {
+	unsigned int i;
+
+	for (i = n; i > 0; i--) {
+		dest[i - 1] = (char) ('0' + v % 10);
+		v /= 10;
+	}
+
+	return dest + n;
+}
+
 /*
 	Puts the date part into "dest". If the day or month occupy only one char they are filled
-	with a leading zero.
+	with a leading zero. Returns the end.
 	
 	[Params]
 	
 		dest: destination. The date is put here.
 		tm: system date-time structure.
 */
-void LOG_PutDate (char* dest, struct tm* lt) { 
-	strcat (dest, "[");
+char* LOG_PutDate (char* dest, struct tm* lt) {
+	*dest++ = '[';
+	dest = LOG_PutDigits (dest, lt->tm_mday, 2);
+	*dest++ = '/';
+	dest = LOG_PutDigits (dest, lt->tm_mon + 1, 2);
+	*dest++ = '/';
+	dest = LOG_PutDigits (dest, lt->tm_year + 1900, 4);
+	*dest++ = ']';
 
-	if (lt->tm_mday < 10)
-		strcat(dest, "0");
+	return dest;
+}
 
-	strcat (strcat (dest, ultoa (lt->tm_mday, LogFile->num, 10)), "/");
+/*
+	Idem to "LOG_PutDate()" but with the time part, with no closing bracket
+	for the fraction of second.
+*/
+char* LOG_PutTime (char* dest, struct tm* lt) {
+	*dest++ = '[';
+	dest = LOG_PutDigits (dest, lt->tm_hour, 2);
+	*dest++ = ':';
+	dest = LOG_PutDigits (dest, lt->tm_min, 2);
+	*dest++ = ':';
+	dest = LOG_PutDigits (dest, lt->tm_sec, 2);
 
-	if (lt->tm_mon < 10)
-		strcat(dest, "0");
+	return dest;
+}
 
-	strcat (strcat (dest, ultoa (lt->tm_mon + 1, LogFile->num, 10)), "/");
-	strcat (dest, ultoa (lt->tm_year + 1900, LogFile->num, 10));
-	strcat (dest, "]");
+/*
+	Takes the time of a message, from the clock "LOG_SetPrecision()" chose.
+*/
+static void LOG_GetTime (struct timespec* t) {
+	clock_gettime (LogClock, t);
 }
 
 /*
-	Idem to "LOG_PutDate()" but with the time part.
+	Puts the line of message "msg", logged at "t", on "dest" and returns its
+	length, with the fraction of second "precision" asks. The head is rebuilt
+	only if the second changed since the last one of the thread.
 */
-void LOG_PutTime (char* dest, struct tm* lt) {
-	strcat	(dest, "[");
+unsigned int LOG_WriteLogAuxHead (char* dest, const struct timespec* t, enum LOGPRECISION precision, const char* msg) {
+	struct tm lt;
+	size_t len;
+	char* d;
 
-	if (lt->tm_hour < 10)
-		strcat (dest, "0");
+	if ((LogBuffers.headlen == 0) || (t->tv_sec != LogBuffers.second)) {
+/* The CRT of Windows keeps the result of localtime() per thread. */
+#if defined _WIN32
+		lt = *localtime (&t->tv_sec);
+#else
+		localtime_r (&t->tv_sec, &lt);
+#endif
+		d = LOG_PutTime (LOG_PutDate (LogBuffers.head, &lt), &lt);
+		LogBuffers.headlen = d - LogBuffers.head;
+		LogBuffers.second = t->tv_sec;
+	}
+	memcpy (dest, LogBuffers.head, LogBuffers.headlen);
+	d = dest + LogBuffers.headlen;
+	switch (precision) {
+		case LOGMILLISECONDS:
+			*d++ = '.';
+			d = LOG_PutDigits (d, t->tv_nsec / 1000000, 3);
+			break;
 
-	strcat (strcat (dest, ultoa(lt->tm_hour, LogFile->num, 10)), ":");
+		case LOGMICROSECONDS:
+			*d++ = '.';
+			d = LOG_PutDigits (d, t->tv_nsec / 1000, 6);
+			break;
 
-	if (lt->tm_min < 10)
-		strcat (dest, "0");
+		default:
+			break;
+	}
+	*d++ = ']';
+	*d++ = '[';
+	len = strlen (msg);
+	memcpy (d, msg, len);
+	d += len;
+	*d++ = ']';
 
-	strcat (strcat (dest, ultoa (lt->tm_min, LogFile->num, 10)), ":");
+	return d - dest;
+}
 
-	if (lt->tm_sec < 10)
-		strcat (dest, "0");
+void LOG_WriteLogAuxTail (char* dest, unsigned int len) {
+	*(dest + len) = 0xA;
+	fwrite (dest, len + 1, 1, LogFile->file);
+}
 
-	strcat (dest, ultoa(lt->tm_sec, LogFile->num, 10));
-	strcat (dest, "]");
+/*
+	Tells if the slot at "pos" of the queue is filled.
+*/
+static BOOL LOG_SlotReady (logfile_t* lf, unsigned int pos) {
+	return __atomic_load_n (&lf->slots[pos & lf->mask].seq, __ATOMIC_SEQ_CST) == pos + 1;
 }
 
 /*
-	Logs the kind of the message. The kind may be ERROR, WARNING or INFORMATION.
+	Claims the next slot of the queue, on position "*pos". With the queue
+	full it waits or gives the message up, as "LogFile->full" says, and
+	returns "NULL".
 */
-void LOG_WriteLogKind (char* dest, enum LOGKIND kind) {
-	switch (kind) {
-		case LOGERROR:
-			strcat (dest, "[ERROR]");
-			break;
-		
-		case LOGWARNING:
-			strcat (dest, "[WARNING]");
-			break;
-			
-		case LOGINFORMATION:
-			strcat (dest, "[INFORMATION]");
-			break;
+static logslot_t* LOG_ClaimSlot (unsigned int* pos) {
+	logslot_t* slot;
+	int dif;
+
+	*pos = __atomic_load_n (&LogFile->tail, __ATOMIC_RELAXED);
+	for (;;) {
+		slot = &LogFile->slots[*pos & LogFile->mask];
+		dif = (int) (__atomic_load_n (&slot->seq, __ATOMIC_ACQUIRE) - *pos);
+		if (dif == 0) {
+			if (__atomic_compare_exchange_n (&LogFile->tail, pos, *pos + 1, TRUE, __ATOMIC_RELAXED,
+					__ATOMIC_RELAXED))
+				return slot;
+		} else if (dif < 0) {
+			/* The slot is still being written from the last lap. */
+			if (LogFile->full != LOGBLOCK) {
+				__atomic_fetch_add (&LogFile->dropped, 1, __ATOMIC_RELAXED);
+				__atomic_fetch_add (&LogFile->unreported, 1, __ATOMIC_RELAXED);
+				return NULL;
+			}
+			sched_yield ();
+			*pos = __atomic_load_n (&LogFile->tail, __ATOMIC_RELAXED);
+		} else
+			*pos = __atomic_load_n (&LogFile->tail, __ATOMIC_RELAXED);
 	}
 }
 
-void LOG_WriteLogAuxHead (char* dest, const char* msg) {
-	time_t t;
-	struct tm* lt;
+/*
+	Hands the filled slot at "pos" to the writer thread.
+*/
+static void LOG_PublishSlot (logslot_t* slot, unsigned int pos) {
+	enum LOGWRITER state;
 
-	*dest = '\0';
-	time (&t);
-	lt = localtime (&t);
-	LOG_PutDate (dest, lt);
-	LOG_PutTime (dest, lt);
-	strcat (strcat (strcat (dest, "["), msg), "]");
+	/* Sequentially consistent against the writer going to sleep. */
+	__atomic_store_n (&slot->seq, pos + 1, __ATOMIC_SEQ_CST);
+	/* An idle writer is woken by the first message, a napping one only by the
+	   one that fills half the queue. Just one producer does it. */
+	state = __atomic_load_n (&LogFile->sleeping, __ATOMIC_SEQ_CST);
+	if ((state == WRITER_AWAKE) || ((state == WRITER_NAPPING) &&
+			(pos - __atomic_load_n (&LogFile->head, __ATOMIC_RELAXED) < (LogFile->mask >> 1))))
+		return;
+	if (__atomic_exchange_n (&LogFile->sleeping, WRITER_AWAKE, __ATOMIC_SEQ_CST) != WRITER_AWAKE) {
+		pthread_mutex_lock (&LogFile->lock);
+		pthread_cond_signal (&LogFile->wake);
+		pthread_mutex_unlock (&LogFile->lock);
+	}
 }
 
-void LOG_WriteLogAuxTail (char* dest) {
-	int len;
+/*
+	Queues a message for the writer thread.
+*/
+static void LOG_PostLog (const char* msg, va_list vl) {
+	logslot_t* slot;
+	unsigned int pos;
 
-	len = strlen (dest);
-	*(dest + len) = 0xA;
-	fwrite (dest, len + 1, 1, LogFile->file);
+	if ((slot = LOG_ClaimSlot (&pos)) == NULL)
+		return;
+	slot->id = 0;
+	LOG_GetTime (&slot->time);
+	vsnprintf (slot->text, sizeof (slot->text), msg, vl);
+	LOG_PublishSlot (slot, pos);
+}
+
+/*
+	Puts "v" on "d" as a varint, 7 bits a byte from the lowest ones, and
+	returns the end.
+*/
+static BYTE* LOG_PutVarint (BYTE* d, unsigned long long v) {
+	while (v >= 0x80) {
+		*d++ = (BYTE) (v | 0x80);
+		v >>= 7;
+	}
+	*d++ = (BYTE) v;
+
+	return d;
+}
+
+/*
+	Maps signed integers to unsigned ones, small the ones near 0.
+*/
+static unsigned long long LOG_ZigZag (long long v) {
+	return ((unsigned long long) v << 1) ^ (unsigned long long) (v >> 63);
+}
+
+static long long LOG_UnZigZag (unsigned long long v) {
+	return (long long) (v >> 1) ^ -(long long) (v & 1);
+}
+
+/*
+	Packs the arguments of format "f" from "vl" on the "room" bytes of "d"
+	and returns their size. Strings are cut to leave room for the rest.
+*/
+static unsigned int LOG_PackArgs (const logformat_t* f, BYTE* d, unsigned int room, va_list vl) {
+	const char* s;
+	const char* e;
+	unsigned long long v;
+	unsigned int k;
+	size_t len;
+	double x;
+	BYTE* p;
+	int last;
+
+	for (p = d, last = -1, k = 0; k < f->count; k++) {
+		switch (f->args[k]) {
+			case ARG_SCHAR:
+				v = LOG_ZigZag ((signed char) va_arg (vl, int));
+				break;
+
+			case ARG_SHORT:
+				v = LOG_ZigZag ((short) va_arg (vl, int));
+				break;
+
+			case ARG_INT:
+				last = va_arg (vl, int);
+				v = LOG_ZigZag (last);
+				break;
+
+			case ARG_LONG:
+				v = LOG_ZigZag (va_arg (vl, long));
+				break;
+
+			case ARG_LLONG:
+				v = LOG_ZigZag (va_arg (vl, long long));
+				break;
+
+			case ARG_INTMAX:
+				v = LOG_ZigZag (va_arg (vl, intmax_t));
+				break;
+
+			case ARG_SSIZE:
+				v = LOG_ZigZag ((ptrdiff_t) va_arg (vl, size_t));
+				break;
+
+			case ARG_PTRDIFF:
+				v = LOG_ZigZag (va_arg (vl, ptrdiff_t));
+				break;
+
+			case ARG_UCHAR:
+				v = (unsigned char) va_arg (vl, unsigned int);
+				break;
+
+			case ARG_USHORT:
+				v = (unsigned short) va_arg (vl, unsigned int);
+				break;
+
+			case ARG_UINT:
+				v = va_arg (vl, unsigned int);
+				break;
+
+			case ARG_ULONG:
+				v = va_arg (vl, unsigned long);
+				break;
+
+			case ARG_ULLONG:
+				v = va_arg (vl, unsigned long long);
+				break;
+
+			case ARG_UINTMAX:
+				v = va_arg (vl, uintmax_t);
+				break;
+
+			case ARG_SIZE:
+				v = va_arg (vl, size_t);
+				break;
+
+			case ARG_UPTRDIFF:
+				v = (size_t) va_arg (vl, ptrdiff_t);
+				break;
+
+			case ARG_POINTER:
+				v = (uintptr_t) va_arg (vl, void*);
+				break;
+
+			case ARG_DOUBLE:
+			case ARG_LDOUBLE:
+				x = f->args[k] == ARG_DOUBLE ? va_arg (vl, double) : (double) va_arg (vl, long double);
+				memcpy (p, &x, sizeof (x));
+				p += sizeof (x);
+				continue;
+
+			default:
+				if ((s = va_arg (vl, const char*)) == NULL)
+					s = "(null)";
+				/* Every argument left takes 10 bytes at most. */
+				len = room - (p - d) - 10 * (f->count - k);
+				if ((f->precision[k] >= 0) && ((size_t) f->precision[k] < len))
+					len = f->precision[k];
+				if ((f->precision[k] == -2) && (last >= 0) && ((size_t) last < len))
+					len = last;
+				if ((e = (const char*) memchr (s, 0, len)) != NULL)
+					len = e - s;
+				p = LOG_PutVarint (p, len);
+				memcpy (p, s, len);
+				p += len;
+				continue;
+		}
+		p = LOG_PutVarint (p, v);
+	}
+
+	return p - d;
+}
+
+/*
+	Queues a message of registered format "id" for the writer thread, with
+	its arguments packed.
+*/
+static void LOG_PostBinary (unsigned int id, va_list vl) {
+	logslot_t* slot;
+	unsigned int pos;
+
+	if ((slot = LOG_ClaimSlot (&pos)) == NULL)
+		return;
+	slot->id = id;
+	LOG_GetTime (&slot->time);
+	slot->size = LOG_PackArgs (&LogFormats[id], (BYTE*) slot->text, sizeof (slot->text), vl);
+	LOG_PublishSlot (slot, pos);
+}
+
+/*
+	Writes a record of a binary log with id "id", time "t" and "size" bytes of
+	arguments "args", which are a text to put as a string for "BINARY_TEXT".
+*/
+static void LOG_WriteRecord (logfile_t* lf, unsigned int id, const struct timespec* t, const char* args,
+			unsigned int size) {
+	BYTE n[10];
+	BYTE* d;
+	BYTE* e;
+	long long ns;
+
+	ns = (long long) t->tv_sec * 1000000000 + t->tv_nsec;
+	d = LOG_PutVarint ((BYTE*) LogBuffers.temp, id);
+	d = LOG_PutVarint (d, LOG_ZigZag (ns - lf->last));
+	lf->last = ns;
+	e = n;
+	if (id == BINARY_TEXT)
+		e = LOG_PutVarint (n, size);
+	d = LOG_PutVarint (d, size + (e - n));
+	memcpy (d, n, e - n);
+	d += e - n;
+	memcpy (d, args, size);
+	fwrite (LogBuffers.temp, d + size - (BYTE*) LogBuffers.temp, 1, lf->file);
+}
+
+/*
+	Writer thread of asynchronous mode. Writes the queued messages to the
+	file buffer, and flushes it once the queue is empty, after a line with the
+	messages dropped if "LOGCOUNT" is set. It ends when asked to, with the
+	queue empty.
+*/
+static void* LOG_Writer (void* arg) {
+	logfile_t* lf;
+	logslot_t* slot;
+	struct timespec t;
+	unsigned long long n;
+	unsigned int head, len;
+	BOOL stop;
+
+	lf = (logfile_t*) arg;
+	for (head = 0, stop = FALSE; !stop; ) {
+		while (LOG_SlotReady (lf, head)) {
+			slot = &lf->slots[head & lf->mask];
+			if (lf->binary && (slot->id != 0))
+				LOG_WriteRecord (lf, slot->id, &slot->time, slot->text, slot->size);
+			else if (lf->binary)
+				LOG_WriteRecord (lf, BINARY_TEXT, &slot->time, slot->text, strlen (slot->text));
+			else {
+				len = LOG_WriteLogAuxHead (LogBuffers.temp, &slot->time, LogPrecision, slot->text);
+				LOG_WriteLogAuxTail (LogBuffers.temp, len);
+			}
+			__atomic_store_n (&slot->seq, head + lf->mask + 1, __ATOMIC_RELEASE);
+			__atomic_store_n (&lf->head, ++head, __ATOMIC_RELAXED);
+		}
+		if ((lf->full == LOGCOUNT) && ((n = __atomic_exchange_n (&lf->unreported, 0, __ATOMIC_RELAXED)) > 0)) {
+			snprintf (LogBuffers.formated, sizeof (LogBuffers.formated), "%llu messages dropped", n);
+			LOG_GetTime (&t);
+			if (lf->binary)
+				LOG_WriteRecord (lf, BINARY_TEXT, &t, LogBuffers.formated, strlen (LogBuffers.formated));
+			else {
+				len = LOG_WriteLogAuxHead (LogBuffers.temp, &t, LogPrecision, LogBuffers.formated);
+				LOG_WriteLogAuxTail (LogBuffers.temp, len);
+			}
+		}
+		fflush (lf->file);
+		/* Idle until a message comes, and then a nap for the batch to gather,
+		   unless the queue gets half full. It's idle again after every wake,
+		   as the producer that woke it may have filled a later slot. */
+		pthread_mutex_lock (&lf->lock);
+		for (;;) {
+			__atomic_store_n (&lf->sleeping, WRITER_IDLE, __ATOMIC_SEQ_CST);
+			if (LOG_SlotReady (lf, head) || lf->stop)
+				break;
+			pthread_cond_wait (&lf->wake, &lf->lock);
+		}
+		/* No nap if the queue got half full before the producers could see
+		   it napping. */
+		__atomic_store_n (&lf->sleeping, WRITER_NAPPING, __ATOMIC_SEQ_CST);
+		if (!lf->stop && !LOG_SlotReady (lf, head + (lf->mask >> 1))) {
+			clock_gettime (CLOCK_REALTIME, &t);
+			t.tv_nsec += BATCH_INTERVAL * 1000000L;
+			if (t.tv_nsec >= 1000000000L) {
+				t.tv_sec++;
+				t.tv_nsec -= 1000000000L;
+			}
+			pthread_cond_timedwait (&lf->wake, &lf->lock, &t);
+		}
+		__atomic_store_n (&lf->sleeping, WRITER_AWAKE, __ATOMIC_RELAXED);
+		stop = lf->stop && !LOG_SlotReady (lf, head);
+		pthread_mutex_unlock (&lf->lock);
+	}
+
+	return NULL;
+}
+
+/*
+	"LOG_WriteLog()" with the arguments on "vl".
+*/
+static void LOG_VWriteLog (const char* msg, va_list vl) {
+	struct timespec t;
+	unsigned int len;
+
+	if (LogFile->async) {
+		LOG_PostLog (msg, vl);
+		return;
+	}
+	LOG_GetTime (&t);
+	/* Longer messages are cut. */
+	vsnprintf (LogBuffers.formated, sizeof (LogBuffers.formated), msg, vl);
+	len = LOG_WriteLogAuxHead (LogBuffers.temp, &t, LogPrecision, LogBuffers.formated);
+	LOG_WriteLogAuxTail (LogBuffers.temp, len);
 }
 
 /*
   Formats 'msg' with the arguments passed as parameters and writes it to the log's file.
+  In asynchronous mode it's queued to be written by the writer thread. It may be called
+  from any thread. Kinds less severe than the level are ignored, though
+  "LOG_WRITE()" doesn't even evaluate the arguments for them. The kind only
+  filters, lines don't show it.
 */
 void LOG_WriteLog (enum LOGKIND kind, const char* msg, ...) {
 	va_list vl;
 
+	if (kind > __atomic_load_n (&LogLevel, __ATOMIC_RELAXED))
+		return;
 	va_start (vl, msg);
-	vsprintf (LogFile->formated, msg, vl);
+	LOG_VWriteLog (msg, vl);
 	va_end (vl);
-	LOG_WriteLogKind (LogFile->temp, kind);
-	LOG_WriteLogAuxHead (LogFile->temp, LogFile->formated);
-	LOG_WriteLogAuxTail (LogFile->temp);
 }
 
 /*
-	Opens a log file "filename" in append mode. Only one log file is allowed at a time.
-	Returns "TRUE" if it was successfull else returns "FALSE".
-	
+	Logs a message of format "id", from "LOG_RegisterFormat()". A binary log
+	gets the arguments as they are, for the format to be applied when it's
+	decoded. Other logs, or an "id" of 0, get the message formatted as
+	"LOG_WriteLog()" does. Kinds less severe than the level are ignored.
+
 	[Params]
-	
-		filename: file name to log.
+
+		kind: kind of the message.
+		id: id of "format".
+		format: format of the message, and its arguments after it.
 */
-BOOL LOG_OpenLogFile (char* filename) {
+void LOG_WriteBinary (enum LOGKIND kind, unsigned int id, const char* format, ...) {
+	va_list vl;
+
+	if (kind > __atomic_load_n (&LogLevel, __ATOMIC_RELAXED))
+		return;
+	va_start (vl, format);
+	if (LogFile->binary && (id != 0))
+		LOG_PostBinary (id, vl);
+	else
+		LOG_VWriteLog (format, vl);
+	va_end (vl);
+}
+
+/*
+	Allocates "LogFile" and opens its file "filename" for append, as text or
+	binary.
+*/
+static BOOL LOG_OpenFile (char* filename, BOOL binary) {
 	/* File must be closed before re-open it. */
 	if (LogFile)
 		return FALSE;		
@@ -191,21 +699,587 @@ BOOL LOG_OpenLogFile (char* filename) {
 	if ((LogFile = LOG_NewLogFile ()) == NULL)
 		return FALSE;
 	/* Open log file for append. */
-	if ((LogFile->file = fopen (filename, "a")) == NULL)
+	if ((LogFile->file = fopen (filename, binary ? "ab" : "a")) == NULL)
 		goto fail;
 
 	return TRUE;
 	
 fail:
 	LOG_FreeLogFile (LogFile);
+	LogFile = NULL;
+
+	return FALSE;
+}
+
+/*
+	Starts the writer thread of the open "LogFile", with a queue of "length"
+	slots and "full" for when it's full, as "LOG_OpenLogFileAsync()" takes
+	them. The log is closed if it fails.
+*/
+static BOOL LOG_StartWriter (unsigned int length, enum LOGFULL full) {
+	unsigned int size, i;
+
+	for (size = 2; (size < length) && (size < 0x80000000U); size <<= 1)
+		;
+	if (length == 0)
+		size = DEFAULT_QUEUE_LENGTH;
+	if ((LogFile->slots = (logslot_t*) malloc (size * sizeof (logslot_t))) == NULL)
+		goto fail;
+	for (i = 0; i < size; i++)
+		LogFile->slots[i].seq = i;
+	LogFile->mask = size - 1;
+	LogFile->full = full;
+	LogFile->tail = 0;
+	LogFile->dropped = LogFile->unreported = 0;
+	LogFile->sleeping = WRITER_AWAKE;
+	LogFile->stop = FALSE;
+	LogFile->head = 0;
+	setvbuf (LogFile->file, NULL, _IOFBF, ASYNC_BUFFER_LENGTH);
+	if (pthread_mutex_init (&LogFile->lock, NULL) != 0)
+		goto fail;
+	if (pthread_cond_init (&LogFile->wake, NULL) != 0)
+		goto fail1;
+	if (pthread_create (&LogFile->writer, NULL, LOG_Writer, LogFile) != 0)
+		goto fail2;
+	LogFile->async = TRUE;
+
+	return TRUE;
+
+fail2:
+	pthread_cond_destroy (&LogFile->wake);
+fail1:
+	pthread_mutex_destroy (&LogFile->lock);
+fail:
+	LOG_CloseLogFile ();
+
+	return FALSE;
+}
+
+/*
+	Opens a log file "filename" in append mode. Only one log file is allowed at a time.
+	Returns "TRUE" if it was successfull else returns "FALSE".
+	
+	[Params]
+	
+		filename: file name to log.
+*/
+BOOL LOG_OpenLogFile (char* filename) {
+	return LOG_OpenFile (filename, FALSE);
+}
+
+/*
+	As "LOG_OpenLogFile()", but the messages are written by a thread of the
+	log, so "LOG_WriteLog()" only formats the message and queues it.
+	
+	[Params]
+	
+		filename: file name to log.
+		length: queue slots, rounded up to a power of 2 and at least 2. 0 for
+			the default.
+		full: what "LOG_WriteLog()" does with the queue full. "LOGBLOCK" waits
+			for a free slot, "LOGDROP" drops the message and "LOGCOUNT" drops
+			it too, but writes how many were dropped once there is room.
+*/
+BOOL LOG_OpenLogFileAsync (char* filename, unsigned int length, enum LOGFULL full) {
+	if (!LOG_OpenFile (filename, FALSE))
+		return FALSE;
+
+	return LOG_StartWriter (length, full);
+}
+
+/*
+	Writes the definition of format "id" to the binary log, in one piece
+	for it not to mix with the records of the writer thread.
+*/
+static BOOL LOG_WriteFormat (unsigned int id) {
+	size_t len;
+	BYTE* d;
+	BYTE* e;
+
+	len = strlen (LogFormats[id].format);
+	if ((d = (BYTE*) malloc (len + 30)) == NULL)
+		return FALSE;
+	e = LOG_PutVarint (LOG_PutVarint (LOG_PutVarint (d, BINARY_CONTROL), id), len);
+	memcpy (e, LogFormats[id].format, len);
+	fwrite (d, e + len - d, 1, LogFile->file);
+	free (d);
+
+	return TRUE;
+}
+
+/*
+	As "LOG_OpenLogFileAsync()", but for a binary log: "LOG_WriteBinary()"
+	queues its arguments with no formatting at all. The text of the log is
+	got with "LOG_DecodeLogFile()". The formats registered so far are
+	written on it, and the rest will be when registered.
+*/
+BOOL LOG_OpenBinaryLogFile (char* filename, unsigned int length, enum LOGFULL full) {
+	BYTE head[16];
+	WORD order;
+	unsigned int id;
+	BYTE* d;
+
+	if (!LOG_OpenFile (filename, TRUE))
+		return FALSE;
+	d = LOG_PutVarint (LOG_PutVarint (head, BINARY_CONTROL), 0);
+	memcpy (d, BINARY_MAGIC, sizeof (BINARY_MAGIC) - 1);
+	d += sizeof (BINARY_MAGIC) - 1;
+	*d++ = BINARY_VERSION;
+	*d++ = (BYTE) LogPrecision;
+	order = 0x0102;
+	memcpy (d, &order, sizeof (order));
+	d += sizeof (order);
+	fwrite (head, d - head, 1, LogFile->file);
+	pthread_mutex_lock (&LogFormatLock);
+	for (id = BINARY_TEXT + 1; id < LogFormatCount; id++)
+		LOG_WriteFormat (id);
+	LogFile->binary = TRUE;
+	pthread_mutex_unlock (&LogFormatLock);
+
+	return LOG_StartWriter (length, full);
+}
+
+/*
+	Parses the conversion specification of a format after its '%', on "f".
+	Puts the type of its argument on "*arg", how many '*' it has on
+	"*stars", and for strings, their precision, as "logformat_t" keeps it.
+	Returns the end of the specification, or "NULL" if it isn't supported.
+*/
+static const char* LOG_ParseSpec (const char* f, BYTE* arg, unsigned int* stars, int* precision) {
+	unsigned int length;
+
+	*stars = 0;
+	*precision = -1;
+	f += strspn (f, "-+ #0'");
+	if (*f == '*') {
+		(*stars)++;
+		f++;
+	} else
+		f += strspn (f, "0123456789");
+	if (*f == '.') {
+		f++;
+		if (*f == '*') {
+			(*stars)++;
+			*precision = -2;
+			f++;
+		} else {
+			*precision = atoi (f);
+			f += strspn (f, "0123456789");
+		}
+	}
+	/* Length modifiers, in the order of the integer types of "LOGARG". */
+	switch (*f) {
+		case 'h':
+			length = f[1] == 'h' ? 0 : 1;
+			break;
+
+		case 'l':
+			length = f[1] == 'l' ? 4 : 3;
+			break;
+
+		case 'j':
+			length = 5;
+			break;
+
+		case 'z':
+			length = 6;
+			break;
+
+		case 't':
+			length = 7;
+			break;
+
+		case 'L':
+			length = 8;
+			break;
+
+		default:
+			length = 2;
+			break;
+	}
+	f += (length == 0) || (length == 4) ? 2 : length != 2 ? 1 : 0;
+	switch (*f) {
+		case 'd':
+		case 'i':
+			*arg = ARG_SCHAR + length;
+			return length == 8 ? NULL : f + 1;
+
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+			*arg = ARG_UCHAR + length;
+			return length == 8 ? NULL : f + 1;
+
+		case 'c':
+			*arg = ARG_INT;
+			return length == 2 ? f + 1 : NULL;
+
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			*arg = length == 8 ? ARG_LDOUBLE : ARG_DOUBLE;
+			return (length == 2) || (length == 3) || (length == 8) ? f + 1 : NULL;
+
+		case 's':
+			*arg = ARG_STRING;
+			return length == 2 ? f + 1 : NULL;
+
+		case 'p':
+			*arg = ARG_POINTER;
+			return length == 2 ? f + 1 : NULL;
+
+		default:
+			return NULL;
+	}
+}
+
+/*
+	Registers "format", a "printf()" format, for "LOG_WriteBinary()", which
+	is usually done by "LOG_BINARY()" once per call site. Registering the
+	same pointer again gives the same id. It may be called from any thread.
+
+	[Return]
+
+		The id of the format, or 0 if it has "%n", wide characters or more
+		than 16 arguments, or there are too many formats.
+*/
+unsigned int LOG_RegisterFormat (const char* format) {
+	unsigned int id, stars;
+	logformat_t* f;
+	const char* s;
+	int precision;
+	BYTE arg;
+
+	pthread_mutex_lock (&LogFormatLock);
+	for (id = BINARY_TEXT + 1; (id < LogFormatCount) && (LogFormats[id].format != format); id++)
+		;
+	if (id < LogFormatCount)
+		goto done;
+	if (id == MAX_FORMATS) {
+		id = 0;
+		goto done;
+	}
+	f = &LogFormats[id];
+	f->format = format;
+	f->count = 0;
+	for (s = format; (s = strchr (s, '%')) != NULL; ) {
+		if (s[1] == '%') {
+			s += 2;
+			continue;
+		}
+		if (((s = LOG_ParseSpec (s + 1, &arg, &stars, &precision)) == NULL) ||
+				(f->count + stars + 1 > MAX_FORMAT_ARGS)) {
+			id = 0;
+			goto done;
+		}
+		while (stars-- > 0)
+			f->args[f->count++] = ARG_INT;
+		f->precision[f->count] = precision;
+		f->args[f->count++] = arg;
+	}
+	LogFormatCount++;
+	if (LogFile && LogFile->binary)
+		LOG_WriteFormat (id);
+
+done:
+	pthread_mutex_unlock (&LogFormatLock);
+
+	return id;
+}
+
+/*
+	Reads a varint from "*s", before "end", and moves "*s" past it.
+*/
+static BOOL LOG_GetVarint (const BYTE** s, const BYTE* end, unsigned long long* v) {
+	unsigned int shift;
+
+	for (*v = 0, shift = 0; (*s < end) && (shift < 64); shift += 7) {
+		*v |= (unsigned long long) (**s & 0x7F) << shift;
+		if ((*(*s)++ & 0x80) == 0)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/*
+	Reads a varint from file "f", with "*v" untouched at its end.
+*/
+static BOOL LOG_ReadVarint (FILE* f, unsigned long long* v) {
+	unsigned int shift;
+	int c;
+
+	for (*v = 0, shift = 0; (shift < 64) && ((c = getc (f)) != EOF); shift += 7) {
+		*v |= (unsigned long long) (c & 0x7F) << shift;
+		if ((c & 0x80) == 0)
+			return TRUE;
+	}
 
 	return FALSE;
 }
 
 /*
-	Frees memory used for "LogFile". And ensures "LogFile" is NULL.
+	Formats the message of "format" with the packed arguments "args", up to
+	"end", on "dest", "MAX_FORMATED_TEXT_LENGTH" characters at most, as
+	"LOG_WriteLog()" would have done. Each conversion is done on its own,
+	with integers as "long long" and floating point numbers as "double".
+*/
+static BOOL LOG_UnpackArgs (const char* format, const BYTE* args, const BYTE* end, char* dest) {
+	unsigned long long v;
+	unsigned int n, k, stars;
+	char spec[MAX_SPEC_LENGTH + 3];
+	const char* e;
+	size_t room;
+	int precision, w[2], r;
+	double x;
+	BYTE arg;
+	char* d;
+
+	for (d = dest, room = MAX_FORMATED_TEXT_LENGTH + 1; (*format != 0) && (room > 1); ) {
+		if ((*format != '%') || (format[1] == '%')) {
+			*d++ = *format;
+			format += *format == '%' ? 2 : 1;
+			room--;
+			continue;
+		}
+		if (((e = LOG_ParseSpec (format + 1, &arg, &stars, &precision)) == NULL) ||
+				(e - format > MAX_SPEC_LENGTH))
+			return FALSE;
+		/* The length modifier goes away, or turns into "ll" for integers. A
+		   string has no end, so its length goes as the precision. */
+		for (n = 0; (format + n < e - 1) && (strchr ("hljztL", format[n]) == NULL); n++)
+			spec[n] = format[n];
+		if ((arg < ARG_DOUBLE) && (e[-1] != 'c')) {
+			spec[n++] = 'l';
+			spec[n++] = 'l';
+		}
+		spec[n++] = e[-1];
+		spec[n] = 0;
+		if (arg == ARG_STRING) {
+			for (n = 0; (format + n < e - 1) && (format[n] != '.'); n++)
+				spec[n] = format[n];
+			strcpy (spec + n, ".*s");
+		}
+		for (k = 0; k < stars; k++) {
+			if (!LOG_GetVarint (&args, end, &v))
+				return FALSE;
+			w[k] = (int) LOG_UnZigZag (v);
+		}
+		if ((arg == ARG_DOUBLE) || (arg == ARG_LDOUBLE)) {
+			if (end - args < (int) sizeof (x))
+				return FALSE;
+			memcpy (&x, args, sizeof (x));
+			args += sizeof (x);
+			r = stars == 0 ? snprintf (d, room, spec, x) : stars == 1 ? snprintf (d, room, spec, w[0], x) :
+				snprintf (d, room, spec, w[0], w[1], x);
+		} else {
+			if (!LOG_GetVarint (&args, end, &v))
+				return FALSE;
+			if (arg == ARG_STRING) {
+				if ((unsigned long long) (end - args) < v)
+					return FALSE;
+				/* Its precision, if any, was applied on packing. */
+				r = stars - (precision == -2) == 0 ? snprintf (d, room, spec, (int) v, args) :
+					snprintf (d, room, spec, w[0], (int) v, args);
+				args += v;
+			} else if (arg == ARG_POINTER)
+				r = stars == 0 ? snprintf (d, room, spec, (void*) (uintptr_t) v) : stars == 1 ?
+					snprintf (d, room, spec, w[0], (void*) (uintptr_t) v) :
+					snprintf (d, room, spec, w[0], w[1], (void*) (uintptr_t) v);
+			else if (e[-1] == 'c')
+				r = stars == 0 ? snprintf (d, room, spec, (int) LOG_UnZigZag (v)) :
+					snprintf (d, room, spec, w[0], (int) LOG_UnZigZag (v));
+			else if (arg < ARG_UCHAR)
+				r = stars == 0 ? snprintf (d, room, spec, LOG_UnZigZag (v)) : stars == 1 ?
+					snprintf (d, room, spec, w[0], LOG_UnZigZag (v)) :
+					snprintf (d, room, spec, w[0], w[1], LOG_UnZigZag (v));
+			else
+				r = stars == 0 ? snprintf (d, room, spec, v) : stars == 1 ? snprintf (d, room, spec, w[0], v) :
+					snprintf (d, room, spec, w[0], w[1], v);
+		}
+		if (r < 0)
+			return FALSE;
+		r = (size_t) r < room ? r : (int) room - 1;
+		d += r;
+		room -= r;
+		format = e;
+	}
+	*d = 0;
+
+	return TRUE;
+}
+
+/*
+	Turns binary log "filename" into the text of a plain log, on "out". Times
+	get the precision of the head of the file, the one of "LOG_SetPrecision()"
+	is left alone.
+
+	[Return]
+
+		"TRUE" if it was read to its end, "FALSE" if it couldn't be read or
+		is malformed. The lines decoded so far are left on "out".
+*/
+BOOL LOG_DecodeLogFile (char* filename, FILE* out) {
+	unsigned long long id, v, size;
+	enum LOGPRECISION precision;
+	struct timespec t;
+	char** formats;
+	char** grown;
+	unsigned int count, len;
+	const BYTE* s;
+	long long ns;
+	BYTE head[sizeof (BINARY_MAGIC) + 3];
+	BYTE* args;
+	WORD order;
+	BOOL started, ok;
+	FILE* in;
+	int c;
+
+	if ((in = fopen (filename, "rb")) == NULL)
+		return FALSE;
+	if ((args = (BYTE*) malloc (MAX_TEMP_TEXT_LENGTH)) == NULL) {
+		fclose (in);
+		return FALSE;
+	}
+	formats = NULL;
+	count = 0;
+	ns = 0;
+	precision = LOGSECONDS;
+	started = ok = FALSE;
+	order = 0x0102;
+	while ((c = getc (in)) != EOF) {
+		ungetc (c, in);
+		if (!LOG_ReadVarint (in, &id))
+			goto done;
+		if (id == BINARY_CONTROL) {
+			if (!LOG_ReadVarint (in, &id))
+				goto done;
+			/* A new head, and all it had is forgotten. */
+			if (id == 0) {
+				if ((fread (head, sizeof (head), 1, in) != 1) ||
+						(memcmp (head, BINARY_MAGIC, sizeof (BINARY_MAGIC) - 1) != 0) ||
+						(head[sizeof (BINARY_MAGIC) - 1] != BINARY_VERSION) ||
+						(memcmp (head + sizeof (BINARY_MAGIC) + 1, &order, sizeof (order)) != 0))
+					goto done;
+				if (head[sizeof (BINARY_MAGIC)] > LOGMICROSECONDS)
+					goto done;
+				precision = (enum LOGPRECISION) head[sizeof (BINARY_MAGIC)];
+				while (count > 0)
+					free (formats[--count]);
+				ns = 0;
+				started = TRUE;
+				continue;
+			}
+			if (!started || (id >= MAX_FORMATS) || !LOG_ReadVarint (in, &size) || (size > 0xFFFFFF))
+				goto done;
+			if (id >= count) {
+				if ((grown = (char**) realloc (formats, (id + 1) * sizeof (char*))) == NULL)
+					goto done;
+				formats = grown;
+				while (count <= id)
+					formats[count++] = NULL;
+			}
+			free (formats[id]);
+			if ((formats[id] = (char*) malloc (size + 1)) == NULL)
+				goto done;
+			if (fread (formats[id], 1, size, in) != size)
+				goto done;
+			formats[id][size] = 0;
+			continue;
+		}
+		if (!started || !LOG_ReadVarint (in, &v) || !LOG_ReadVarint (in, &size) || (size > MAX_TEMP_TEXT_LENGTH) ||
+				(fread (args, 1, size, in) != size))
+			goto done;
+		ns += LOG_UnZigZag (v);
+		t.tv_sec = ns / 1000000000;
+		t.tv_nsec = ns % 1000000000;
+		if (id == BINARY_TEXT) {
+			s = args;
+			if (!LOG_GetVarint (&s, args + size, &v) || (v != (unsigned long long) (args + size - s)) ||
+					(v > MAX_FORMATED_TEXT_LENGTH))
+				goto done;
+			memcpy (LogBuffers.formated, s, v);
+			LogBuffers.formated[v] = 0;
+		} else if ((id >= count) || (formats[id] == NULL) ||
+				!LOG_UnpackArgs (formats[id], args, args + size, LogBuffers.formated))
+			goto done;
+		len = LOG_WriteLogAuxHead (LogBuffers.temp, &t, precision, LogBuffers.formated);
+		LogBuffers.temp[len] = 0xA;
+		fwrite (LogBuffers.temp, len + 1, 1, out);
+	}
+	ok = started;
+
+done:
+	while (count > 0)
+		free (formats[--count]);
+	free (formats);
+	free (args);
+	fclose (in);
+
+	return ok;
+}
+
+/*
+	Sets the fraction of second on the time of the lines, none by default.
+	It should be set before logging. Time is taken from the coarse clock if
+	it ticks at least as often as "precision" needs.
+*/
+void LOG_SetPrecision (enum LOGPRECISION precision) {
+	struct timespec res;
+
+	LogPrecision = precision;
+	LogClock = COARSE_CLOCK;
+	if ((precision == LOGMICROSECONDS) || ((precision == LOGMILLISECONDS) && ((clock_getres (COARSE_CLOCK, &res) != 0)
+			|| (res.tv_sec > 0) || (res.tv_nsec > 1000000))))
+		LogClock = CLOCK_REALTIME;
+}
+
+/*
+	Sets the least severe kind of message logged, "LOGINFORMATION" by
+	default. It may be changed at any time, from any thread.
+*/
+void LOG_SetLevel (enum LOGKIND level) {
+	__atomic_store_n (&LogLevel, level, __ATOMIC_RELAXED);
+}
+
+/*
+	Returns the least severe kind of message logged.
+*/
+enum LOGKIND LOG_GetLevel () {
+	return __atomic_load_n (&LogLevel, __ATOMIC_RELAXED);
+}
+
+/*
+	Returns how many messages were dropped for a full queue since the log
+	file was opened.
+*/
+unsigned long long LOG_GetDropped () {
+	return LogFile ? __atomic_load_n (&LogFile->dropped, __ATOMIC_RELAXED) : 0;
+}
+
+/*
+	Frees memory used for "LogFile". And ensures "LogFile" is NULL. In
+	asynchronous mode the queued messages are written first, so no thread
+	may log while it's closed.
 */
 void LOG_CloseLogFile () {
-	LOG_FreeLog_File (LogFile);
+	if (LogFile->async) {
+		pthread_mutex_lock (&LogFile->lock);
+		LogFile->stop = TRUE;
+		pthread_cond_signal (&LogFile->wake);
+		pthread_mutex_unlock (&LogFile->lock);
+		pthread_join (LogFile->writer, NULL);
+		pthread_cond_destroy (&LogFile->wake);
+		pthread_mutex_destroy (&LogFile->lock);
+	}
+	if (LogFile->file)
+		fclose (LogFile->file);
+	LOG_FreeLogFile (LogFile);
 	LogFile = NULL;
 }
@@ -0,0 +1,44 @@
+/*
+	File: logdecode.c
+	Creation: 19-10-2026
+	Programming: Gabriel Ferrer
+	Description:
+
+		Turns a binary log, from "LOG_OpenBinaryLogFile()", into the text of
+		a plain log.
+
+			logdecode binarylog [textlog]
+
+		The text goes to "textlog", appended as a log file is, or to the
+		standard output.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "log.h"
+
+int main (int argc, char** argv) {
+	FILE* out;
+	BOOL ok;
+
+	if ((argc < 2) || (argc > 3)) {
+		fprintf (stderr, "Usage: %s binarylog [textlog]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	out = stdout;
+	if ((argc == 3) && ((out = fopen (argv[2], "a")) == NULL)) {
+		perror (argv[2]);
+		return EXIT_FAILURE;
+	}
+	ok = LOG_DecodeLogFile (argv[1], out);
+	if (out != stdout)
+		fclose (out);
+	else
+		fflush (out);
+	if (!ok) {
+		fprintf (stderr, "%s: can't be read or is malformed\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}